@@ -119,19 +119,21 @@ std::ostream &operator<<(std::ostream &os, const AtValue &atValue)
     return os;
 }
 
-bool AtValue::expired(Clock::time_point tp) const
+bool AtValue::expired(const std::tm &tm) const
 {
-    const auto time = Clock::to_time_t(tp);
-    auto *tm = ::std::localtime(&time);
+    if(!expiredDay(tm)) return false;
+    if(!hours_.empty() && !includes(hours_, tm.tm_hour)) return false;
+    if(!minutes_.empty() && !includes(minutes_, tm.tm_min)) return false;
+    if(!seconds_.empty() && !includes(seconds_, tm.tm_sec)) return false;
 
-    ENSURE(tm, CRuntimeError);
+    return true;
+}
 
-    if(!months_.empty() && !includes(months_, tm->tm_mon)) return false;
-    if(!monthdays_.empty() && !includes(monthdays_, tm->tm_mday)) return false;
-    if(!weekdays_.empty() && !includes(weekdays_, tm->tm_wday)) return false;
-    if(!hours_.empty() && !includes(hours_, tm->tm_hour)) return false;
-    if(!minutes_.empty() && !includes(minutes_, tm->tm_min)) return false;
-    if(!seconds_.empty() && !includes(seconds_, tm->tm_sec)) return false;
+bool AtValue::expiredDay(const std::tm &tm) const
+{
+    if(!months_.empty() && !includes(months_, tm.tm_mon)) return false;
+    if(!monthdays_.empty() && !includes(monthdays_, tm.tm_mday)) return false;
+    if(!weekdays_.empty() && !includes(weekdays_, tm.tm_wday)) return false;
 
     return true;
 }
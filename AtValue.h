@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <ctime>
 #include <ostream>
 
 #include "json.h"
@@ -23,7 +24,18 @@ struct AtValue
     friend
     std::ostream &operator<<(std::ostream &, const AtValue &);
 
-    bool expired(Clock::time_point) const;
+    /* tm is civil time of the evaluated second */
+    bool expired(const std::tm &) const;
+    /* calendar part only (month, month day, week day) */
+    bool expiredDay(const std::tm &) const;
+
+    /* empty sequence matches any value */
+    const Seq &seconds() const {return seconds_;}
+    const Seq &minutes() const {return minutes_;}
+    const Seq &hours() const {return hours_;}
+    const Seq &weekdays() const {return weekdays_;}
+    const Seq &monthdays() const {return monthdays_;}
+    const Seq &months() const {return months_;}
 private:
     /* invariant: all sequences are sorted */
     Seq seconds_; /* 0..59 */
@@ -0,0 +1,278 @@
+#include <algorithm>
+
+#include "Brokers.h"
+#include "Ensure.h"
+#include "Log.h"
+
+namespace {
+
+/* first backoff of failed broker, doubled per consecutive failure */
+constexpr auto BACKOFF = std::chrono::milliseconds{100};
+constexpr auto BACKOFF_MAX = std::chrono::milliseconds{5000};
+/* moving RTT weight of new sample is 1 / RTT_WEIGHT */
+constexpr auto RTT_WEIGHT = 8;
+
+} /* namespace */
+
+namespace cron {
+
+Brokers::Brokers(
+    const std::vector<std::string> &addressSeq,
+    std::chrono::milliseconds timeout,
+    std::size_t senders,
+    Transport transport):
+    transport_{std::move(transport)},
+    timeout_{timeout},
+    senders_{senders}
+{
+    ENSURE(transport_, RuntimeError);
+    ENSURE(!addressSeq.empty(), RuntimeError);
+    ENSURE(0 < timeout_.count(), RuntimeError);
+    ENSURE(0 < senders_, RuntimeError);
+
+    for(const auto &address : addressSeq)
+    {
+        ENSURE(!address.empty(), RuntimeError);
+
+        brokers_.emplace_back(new Broker);
+        brokers_.back()->address = address;
+    }
+
+    for(auto &broker : brokers_)
+    {
+        auto *b = broker.get();
+
+        for(std::size_t i = 0; i < senders_; ++i)
+        {
+            b->threads.emplace_back([this, b](){exec(*b);});
+        }
+    }
+}
+
+Brokers::~Brokers()
+{
+    for(auto &broker : brokers_)
+    {
+        for(std::size_t i = 0; i < senders_; ++i) broker->queue.push(nullptr);
+    }
+
+    for(auto &broker : brokers_)
+    {
+        for(auto &thread : broker->threads) thread.join();
+    }
+}
+
+void Brokers::exec(Broker &broker)
+{
+    for(;;)
+    {
+        const auto request = broker.queue.pop();
+
+        if(!request) break;
+
+        /* timed out while queued, not pending anymore */
+        if(request->taken.exchange(true)) continue;
+
+        request->started.set_value();
+
+        PayloadSeq replyPayload;
+        std::exception_ptr error;
+
+        try
+        {
+            if(*request->sent) (*request->sent)();
+            replyPayload = transport_(broker.address, request->service, request->payload);
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+
+            --broker.pending;
+        }
+
+        if(error) request->reply.set_exception(error);
+        else request->reply.set_value(std::move(replyPayload));
+    }
+}
+
+auto Brokers::order() -> std::vector<Broker *>
+{
+    std::vector<Broker *> seq;
+
+    for(const auto &broker : brokers_) seq.push_back(broker.get());
+
+    const auto now = SteadyClock::now();
+
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    Broker *probe = nullptr;
+
+    for(auto *broker : seq)
+    {
+        if(broker->healthy || broker->probing || now < broker->retry) continue;
+
+        probe = broker;
+        probe->probing = true;
+        break;
+    }
+
+    /* probe, healthy with a free sender, healthy busy,
+     * failed past backoff, failed in backoff */
+    const auto rank =
+        [this, now, probe](const Broker *broker)
+        {
+            if(probe == broker) return 0;
+            if(broker->healthy) return senders_ > broker->pending ? 1 : 2;
+            return now < broker->retry ? 4 : 3;
+        };
+
+    /* unmeasured brokers go first to get measured */
+    std::stable_sort(
+        std::begin(seq), std::end(seq),
+        [&rank](const Broker *a, const Broker *b)
+        {
+            const auto aRank = rank(a);
+            const auto bRank = rank(b);
+
+            if(aRank != bRank) return aRank < bRank;
+            return a->rtt < b->rtt;
+        });
+
+    return seq;
+}
+
+void Brokers::succeeded(Broker &broker, std::chrono::microseconds rtt)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    ++broker.requestCount;
+    broker.rtt =
+        broker.rtt.count()
+        ? broker.rtt + (rtt - broker.rtt) / RTT_WEIGHT
+        : std::max(rtt, std::chrono::microseconds{1});
+    broker.healthy = true;
+    broker.probing = false;
+    broker.failures = 0;
+}
+
+void Brokers::failed(Broker &broker)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    ++broker.requestCount;
+    ++broker.failureCount;
+    broker.healthy = false;
+    broker.probing = false;
+    broker.retry =
+        SteadyClock::now()
+        + std::min<std::chrono::milliseconds>(
+            BACKOFF * (1u << std::min(broker.failures, 6u)), BACKOFF_MAX);
+    ++broker.failures;
+}
+
+void Brokers::busy(Broker &broker)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    ++broker.busyCount;
+    --broker.pending;
+    /* not tried, next request may probe it */
+    broker.probing = false;
+}
+
+auto Brokers::exec(
+    const std::string &service,
+    const PayloadSeq &payload,
+    const Sent &sent) -> PayloadSeq
+{
+    using namespace std::chrono;
+
+    std::exception_ptr error;
+
+    for(auto *broker : order())
+    {
+        auto request = std::make_shared<Request>();
+
+        request->service = service;
+        request->payload = payload;
+        request->sent = &sent;
+
+        auto started = request->started.get_future();
+        auto reply = request->reply.get_future();
+        const auto start = SteadyClock::now();
+
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+
+            ++broker->pending;
+        }
+
+        broker->queue.push(request);
+
+        /* not sent later, after the next broker served it */
+        if(std::future_status::ready != started.wait_for(timeout_)
+            && !request->taken.exchange(true))
+        {
+            CRON_ERROR("broker ", broker->address, " busy");
+            busy(*broker);
+            continue;
+        }
+
+        /* taken, the worker may run it, it is not sent elsewhere
+         * however long the reply takes */
+        try
+        {
+            auto replyPayload = reply.get();
+
+            succeeded(*broker, duration_cast<microseconds>(SteadyClock::now() - start));
+            return replyPayload;
+        }
+        catch(const std::exception &except)
+        {
+            CRON_ERROR("broker ", broker->address, ' ', except.what());
+            failed(*broker);
+            error = std::current_exception();
+        }
+    }
+
+    /* every broker was busy */
+    ENSURE(error, RuntimeError);
+    std::rethrow_exception(error);
+}
+
+std::vector<std::string> Brokers::addresses() const
+{
+    std::vector<std::string> seq;
+
+    for(const auto &broker : brokers_) seq.push_back(broker->address);
+
+    return seq;
+}
+
+auto Brokers::stats() const -> std::vector<Stats>
+{
+    std::vector<Stats> seq;
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    for(const auto &broker : brokers_)
+    {
+        seq.push_back(
+            {
+                broker->address,
+                broker->healthy,
+                broker->rtt,
+                broker->requestCount,
+                broker->failureCount,
+                broker->busyCount,
+                broker->pending
+            });
+    }
+
+    return seq;
+}
+
+} /* cron */
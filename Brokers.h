@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Queue.h"
+
+namespace cron {
+
+/* set of equivalent brokers
+ *
+ * A request goes to the healthy broker with the lowest moving RTT
+ * that has a free sender, if it fails the next one is tried.
+ * Failed brokers are tried after healthy ones, the ones failed within
+ * an exponential backoff last, and are healthy again once they reply.
+ * Once its backoff expires, a failed broker is tried first by one
+ * request (probe), so it recovers while others are healthy.
+ * Every broker has a pool of sender threads, requests to a broker are
+ * sent concurrently and a broker stuck in requests only holds its own
+ * senders. A request no sender took within timeout is cancelled and
+ * goes to the next broker. One taken is waited for until its reply,
+ * however long the worker takes, and never goes to another broker
+ * unless the transport failed it (it was not delivered). */
+class Brokers
+{
+public:
+    using PayloadSeq = std::vector<std::string>;
+    /* sends request to broker at address and waits for the reply,
+     * throws if it was not delivered */
+    using Transport =
+        std::function<PayloadSeq(
+            const std::string &address,
+            const std::string &service,
+            const PayloadSeq &)>;
+    /* called by the sender right before the request goes out */
+    using Sent = std::function<void()>;
+
+    struct Stats
+    {
+        std::string address;
+        bool healthy;
+        std::chrono::microseconds rtt;
+        uint64_t requests;
+        uint64_t failures;
+        /* requests no sender took within timeout */
+        uint64_t busy;
+        /* queued or being sent */
+        std::size_t pending;
+    };
+private:
+    using SteadyClock = std::chrono::steady_clock;
+
+    struct Request
+    {
+        std::string service;
+        PayloadSeq payload;
+        /* caller waits for the reply, so it outlives the request */
+        const Sent *sent;
+        std::promise<void> started;
+        std::promise<PayloadSeq> reply;
+        /* by sender thread or by timed out exec() (cancelled) */
+        std::atomic<bool> taken{false};
+    };
+
+    using RequestPtr = std::shared_ptr<Request>;
+
+    struct Broker
+    {
+        std::string address;
+        /* null stops a sender thread */
+        Queue<RequestPtr> queue;
+        std::vector<std::thread> threads;
+        /* guarded by Brokers::mutex_ */
+        /* queued or being sent, senders are free while less than senders_ */
+        std::size_t pending = 0;
+        /* moving average, 0 - not measured yet */
+        std::chrono::microseconds rtt{0};
+        bool healthy = true;
+        /* failed, one request is trying it */
+        bool probing = false;
+        /* consecutive failures */
+        unsigned failures = 0;
+        SteadyClock::time_point retry;
+        uint64_t requestCount = 0;
+        uint64_t failureCount = 0;
+        uint64_t busyCount = 0;
+    };
+
+    Transport transport_;
+    std::chrono::milliseconds timeout_;
+    std::size_t senders_;
+    std::vector<std::unique_ptr<Broker>> brokers_;
+    mutable std::mutex mutex_;
+
+    void exec(Broker &);
+    /* claims probe of a failed broker past its backoff */
+    std::vector<Broker *> order();
+    void succeeded(Broker &, std::chrono::microseconds rtt);
+    void failed(Broker &);
+    /* not taken within timeout */
+    void busy(Broker &);
+public:
+    /* timeout: for a free sender of a broker, not for the reply
+     * senders: threads (concurrent requests) per broker */
+    Brokers(
+        const std::vector<std::string> &addressSeq,
+        std::chrono::milliseconds timeout,
+        std::size_t senders,
+        Transport);
+    ~Brokers();
+
+    Brokers(const Brokers &) = delete;
+    Brokers &operator=(const Brokers &) = delete;
+
+    std::vector<std::string> addresses() const;
+
+    /* client request, throws if no broker replied */
+    PayloadSeq exec(const std::string &service, const PayloadSeq &, const Sent &sent = {});
+    std::vector<Stats> stats() const;
+};
+
+} /* cron */
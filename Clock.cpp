@@ -0,0 +1,22 @@
+#include "Clock.h"
+#include "Ensure.h"
+
+namespace cron {
+
+std::tm TimeSource::localtime(Clock::time_point tp)
+{
+    const auto time = Clock::to_time_t(tp);
+
+    std::tm tm;
+
+    ENSURE(::localtime_r(&time, &tm), CRuntimeError);
+    return tm;
+}
+
+const TimeSource &systemTime()
+{
+    static const SystemTime time;
+    return time;
+}
+
+} /* cron */
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+
+namespace cron {
+
+using Clock = std::chrono::system_clock;
+
+/* source of current time, Cron never reads the clock directly
+ * so schedules can be evaluated in virtual time */
+class TimeSource
+{
+public:
+    virtual ~TimeSource() = default;
+    virtual Clock::time_point now() const = 0;
+
+    /* civil time, reentrant */
+    static std::tm localtime(Clock::time_point);
+};
+
+class SystemTime: public TimeSource
+{
+public:
+    Clock::time_point now() const override {return Clock::now();}
+};
+
+/* time moves only when told to */
+class VirtualTime: public TimeSource
+{
+    Clock::time_point now_;
+public:
+    explicit VirtualTime(Clock::time_point now): now_{now}
+    {}
+
+    Clock::time_point now() const override {return now_;}
+    void set(Clock::time_point now) {now_ = now;}
+};
+
+const TimeSource &systemTime();
+
+} /* cron */
@@ -1,7 +1,12 @@
-//#include <algorithm>
+#include <algorithm>
+#include <cstring>
 //#include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <future>
+#include <iomanip>
+#include <iostream>
+#include <thread>
 //#include <iterator>
 //#include <limits>
 
@@ -9,14 +14,117 @@
 
 #include "Cron.h"
 #include "Ensure.h"
+#include "Log.h"
+#include "Simulation.h"
 #include "Trace.h"
 #include "fs.h"
 #include "mdp/Client.h"
 #include "mdp/MDP.h"
+#include "mdp/Worker.h"
 
 namespace {
+
+constexpr auto COMMAND = "command";
+constexpr auto ID = "id";
+constexpr auto JOB = "job";
+constexpr auto JOBS = "jobs";
+constexpr auto TIMER = "timer";
+constexpr auto TIMERS = "timers";
+constexpr auto JITTER = "jitter_us";
+constexpr auto BOUND = "lt";
+constexpr auto COUNT = "count";
+constexpr auto MAX = "max";
+constexpr auto BATCHES = "batches";
+constexpr auto BATCHED_JOBS = "batched_jobs";
+constexpr auto BATCH_FAILED = "batch_failed";
+constexpr auto LATE = "late";
+constexpr auto SKIPPED = "skipped";
+constexpr auto DEFERRED = "deferred";
+constexpr auto DROPPED = "dropped";
+constexpr auto IN_FLIGHT = "in_flight";
+constexpr auto BROKERS = "brokers";
+constexpr auto ADDRESS = "address";
+constexpr auto HEALTHY = "healthy";
+constexpr auto RTT_US = "rtt_us";
+constexpr auto BUSY = "busy";
+constexpr auto PENDING = "pending";
+constexpr auto REQUESTS = "requests";
+constexpr auto FAILURES = "failures";
+constexpr auto TICK_MS = "tick_ms";
+constexpr auto SEQ = "seq";
 constexpr auto SERVICE = "service";
 constexpr auto PAYLOAD = "payload";
+constexpr auto AT_MS = "at_ms";
+constexpr auto AFTER_MS = "after_ms";
+constexpr auto STATUS = "status";
+constexpr auto REASON = "reason";
+
+constexpr auto ADD = "add";
+constexpr auto REMOVE = "remove";
+constexpr auto LIST = "list";
+constexpr auto FIRE = "fire";
+constexpr auto SCHEDULE = "schedule";
+constexpr auto CANCEL = "cancel";
+constexpr auto STATS = "stats";
+constexpr auto HANDOVER = "handover";
+
+constexpr auto OK = "ok";
+constexpr auto FAILED = "error";
+
+/* missed seconds are caught up unless clock jumped this far */
+constexpr auto CATCH_UP = std::chrono::seconds{60};
+
+/* one-shot timer id in firing records */
+constexpr auto ONE_SHOT_PREFIX = "timer:";
+
+int64_t nanoseconds(cron::Clock::time_point tp)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+/* truncated, nul terminated */
+template <std::size_t N>
+void copy(char (&to)[N], const std::string &from)
+{
+    const auto size = std::min(from.size(), N - 1);
+
+    std::memcpy(to, from.data(), size);
+    to[size] = '\0';
+}
+
+int64_t epochMs(cron::Clock::time_point tp)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+}
+
+/* latest epoch ms a clock time point holds */
+constexpr int64_t MAX_EPOCH_MS =
+    std::chrono::duration_cast<std::chrono::milliseconds>(cron::Clock::duration::max()).count();
+
+std::string oneShotId(uint64_t handle)
+{
+    return ONE_SHOT_PREFIX + std::to_string(handle);
+}
+
+/* concurrent requests per broker, at least one per dispatch thread */
+constexpr std::size_t BROKER_SENDERS = 4;
+
+/* standby lease acquire period, bounds takeover delay */
+constexpr auto LEASE_POLL = std::chrono::milliseconds{50};
+
+/* holder renews every tick, past it without renewal it is taken over */
+constexpr auto LEASE_STALE = std::chrono::milliseconds{3000};
+
+/* monitor restart period while watched directory is not accessible */
+constexpr auto MONITOR_RETRY = std::chrono::milliseconds{500};
+
+/* handover socket accept() period, stop flag is checked in between */
+constexpr auto HANDOVER_POLL = std::chrono::milliseconds{500};
+
+/* low jitter: sleep until this close to deadline then spin */
+constexpr auto SPIN = std::chrono::microseconds{200};
+constexpr auto TIMER_SLACK_NSECS = 1ul;
+constexpr std::size_t PREFAULT_STACK = 256 * 1024;
 
 struct StopGuard
 {
@@ -30,225 +138,1415 @@ struct StopGuard
 
 namespace cron {
 
-Job parseJob(std::string path, const json &input)
+Cron::Cron(const Config &config, const TimeSource &time):
+    time_{time},
+    basePath_{resolveParent(config.basePath)},
+    adminService_{config.adminService},
+    statePath_{config.statePath},
+    batchLimitMap_{config.batch},
+    lowJitter_{config.lowJitter},
+    cpus_{config.cpus},
+    priority_{config.priority},
+    wheelOrigin_{time_.now()},
+    handoverPath_{config.handoverPath}
 {
-    const auto atValue = parseAtValue(input);
+    ENSURE(isDirectory(basePath_), RuntimeError);
 
-    ENSURE(input.count(SERVICE), RuntimeError);
-    ENSURE(input[SERVICE].is_string(), RuntimeError);
+    rescan();
+    load();
 
-    const auto service = input[SERVICE].get<std::string>();
+    table_.publish(snapshot());
 
-    ENSURE(input.count(PAYLOAD), RuntimeError);
-    ENSURE(input[PAYLOAD].is_array(), RuntimeError);
+    if(lowJitter_)
+    {
+        /* log thread is not real time, started before */
+        AsyncLog::instance();
+        /* sender and dispatch pool threads started below inherit it,
+         * a failure (e.g. EPERM) is fatal, threads started later by
+         * exec() set themselves back by normal() */
+        normalCpus_ = threadCpus();
+        realTime();
+    }
 
-    const json payload = input[PAYLOAD].get<json>();
+    if(!config.brokers.empty())
+    {
+        brokers_.reset(
+            new Brokers{
+                config.brokers,
+                config.brokerTimeout,
+                std::max(config.dispatchThreads, BROKER_SENDERS),
+                [](const std::string &address, const std::string &service, const PayloadSeq &payload)
+                {
+                    Client client;
 
-    return
+                    return client.exec(address, service, payload);
+                }});
+    }
+
+    if(brokers_)
     {
-        std::move(path),
-        std::move(atValue),
-        std::move(service),
-        std::move(payload)
-    };
+        dispatcher_.reset(new Dispatcher{config.dispatchThreads, config.inFlight});
+    }
+
+    if(!config.leasePath.empty()) lease_.reset(new Lease{config.leasePath, LEASE_STALE});
+
+    if(!config.ring.empty())
+    {
+        ring_.reset(new FireRing{config.ring, config.ringCapacity});
+    }
 }
 
-std::ostream &operator<<(std::ostream &os, const Job &job)
+void Cron::update(const std::string &path)
 {
-    os
-        << job.atValue_
-        << ' ' << job.path_
-        << ' ' << job.service_
-        << ' ' << job.payload_.dump();
-    return os;
+    CRON_DEBUG(path);
+
+    JobFile file;
+
+    /* parse outside of the lock, file may be big,
+     * if file is not accessible any existing jobs are erased */
+    if(access(path, AccessMode::Exist | AccessMode::Read) && isRegularFile(path))
+    {
+        /* taken first, file changed while parsed is parsed again */
+        file.id = fileId(path);
+
+        auto jobSeq = loadJobFile(path);
+
+        if(!jobSeq.empty()) file.jobSeq = std::make_shared<const JobSeq>(std::move(jobSeq));
+    }
+
+    std::lock_guard<std::mutex> lock{tableMutex_};
+
+    if(file.jobSeq) jobFileMap_[path] = std::move(file);
+    else jobFileMap_.erase(path);
+
+    changed();
 }
 
-Cron::Cron(const std::string &brokerAddr, const std::string &basePath):
-    brokerAddr_{std::move(brokerAddr)},
-    basePath_{resolvePath(basePath)}
+void Cron::rescan()
 {
-    ENSURE(isDirectory(basePath_), RuntimeError);
+    const auto target = resolvePath(basePath_);
+
+    /* written by this thread only (or before it is started) */
+    JobFileMap previous;
+
+    {
+        std::lock_guard<std::mutex> lock{tableMutex_};
+
+        previous = jobFileMap_;
+    }
 
-    const auto list = listDirectory(basePath_);
+    JobFileMap next;
 
-    for(const auto &name : list)
+    for(const auto &name : listDirectory(basePath_))
     {
         const auto path = basePath_ + '/' + name;
 
-        if(!isRegularFile(path)) continue;
-        if(!isExtention(path, ".json")) continue;
+        if(!isJobFile(path)) continue;
+
+        const auto i = previous.find(path);
+
+        try
+        {
+            if(!isRegularFile(path)) continue;
+
+            const auto id = fileId(path);
+
+            if(previous.end() != i && id == i->second.id)
+            {
+                next.emplace(path, i->second);
+                continue;
+            }
+
+            auto jobSeq = loadJobFile(path);
 
-        update(path);
+            if(jobSeq.empty()) continue;
+
+            next.emplace(path, JobFile{id, std::make_shared<const JobSeq>(std::move(jobSeq))});
+        }
+        catch(const std::exception &except)
+        {
+            /* removed since listed (ENOENT), its jobs go */
+            if(!access(path, AccessMode::Exist)) continue;
+
+            /* file that does not parse keeps its jobs */
+            TRACE(TraceLevel::Error, path, ' ', except.what());
+            if(previous.end() != i) next.emplace(path, i->second);
+        }
     }
-}
 
-void Cron::update(const std::string &path)
-{
-    TRACE(TraceLevel::Debug, path);
+    std::size_t added = 0, modified = 0, removed = 0;
 
-    /* erase any existing */
-    jobSeqMap_.erase(path);
-    /* if file is not accessible ignore it */
-    if(!access(path, AccessMode::Exist | AccessMode::Read)) return;
+    for(const auto &i : next)
+    {
+        const auto j = previous.find(i.first);
 
-    json input;
-    std::ifstream{path} >> input;
+        if(previous.end() == j) ++added;
+        else if(j->second.jobSeq != i.second.jobSeq) ++modified;
+    }
 
-    ENSURE(input.is_array(), RuntimeError);
+    for(const auto &i : previous) removed += !next.count(i.first);
 
-    JobSeq seq;
+    TRACE(
+        TraceLevel::Info,
+        "rescan ", target, " added ", added, " modified ", modified, " removed ", removed);
 
-    for(const auto &i : input)
     {
-        seq.push_back(parseJob(path, i));
-        LOG(TraceLevel::Info, path, ' ', seq.back());
+        std::lock_guard<std::mutex> lock{tableMutex_};
+
+        jobFileMap_ = std::move(next);
+
+        /* one version for the whole tree */
+        if(added || modified || removed) changed();
     }
 
-    if(!seq.empty()) jobSeqMap_[path] = seq;
+    target_ = target;
 }
 
-void Cron::update(const Monitor::EventSeq &eventSeq)
+bool Cron::update(const Monitor::EventSeq &eventSeq)
 {
+    using EventType = Monitor::EventType;
+
     for(const auto &event : eventSeq)
     {
-        using EventType = Monitor::EventType;
+        /* watched directory itself moved/deleted (its target swapped) */
+        if(event.isEvent(EventType::DeleteSelf) || event.isEvent(EventType::MoveSelf)) return true;
 
-        ASSERT(!event.isEvent(EventType::DeleteSelf));
-        ASSERT(!event.isEvent(EventType::MoveSelf));
+        /* basePath_ directory (symbolic link replaced) */
+        if(basePath_ != event.basePath())
+        {
+            if(baseName(basePath_) == event.name()) return true;
+            continue;
+        }
 
         const auto path = event.path();
 
         //TRACE(TraceLevel::Debug, event);
 
-        // check if path still exists
-        if(!access(path, AccessMode::Exist | AccessMode::Read)) continue;
-        if(!isRegularFile(path)) continue;
-        if(!isExtention(path, ".json")) continue;
+        /* file being written may not parse yet, its jobs are kept,
+         * rest of the events (close after write) must not be lost */
+        try
+        {
+            if(!isJobFile(path))
+            {
+                /* directory symbolic link (..data) the job files point
+                 * through replaced inside watched directory */
+                if(
+                    (event.isEvent(EventType::MovedTo) || event.isEvent(EventType::Create))
+                    && isLink(path)
+                    && isDirectory(path))
+                {
+                    return true;
+                }
+
+                continue;
+            }
 
-        update(path);
+            /* deleted/moved from paths are handled by update(path) */
+            update(path);
+        }
+        catch(const std::exception &except)
+        {
+            TRACE(TraceLevel::Error, path, ' ', except.what());
+        }
     }
+
+    return false;
 }
 
 void Cron::dispatch(std::chrono::system_clock::time_point at)
 {
-    for(const auto &jobSeq : jobSeqMap_)
+    /* civil time is shared by all jobs of the tick */
+    const auto tm = TimeSource::localtime(at);
+    const auto *table = table_.read();
+
+    const auto flush =
+        [this]()
+        {
+            for(auto &i : batchMap_)
+            {
+                if(!i.second.ids.empty()) submit(i.first, i.second);
+            }
+        };
+
+    const Job *previous = nullptr;
+
+    const auto fire =
+        [&](const Job *job)
+        {
+            /* batched jobs do not wait for lower priority ones */
+            if(previous && previous->priority() != job->priority()) flush();
+
+            previous = job;
+
+            const auto limit = batchLimitMap_.find(job->service());
+
+            if(batchLimitMap_.end() == limit)
+            {
+                dispatch(*job, at, frame_);
+                return;
+            }
+
+            /* previous request is outstanding, sent on its own
+             * (or not) as overlap policy says */
+            if(!dispatcher_->reserve(job->id()))
+            {
+                dispatch(*job, at, frame_);
+                return;
+            }
+
+            auto &batch = batchMap_[job->service()];
+
+            CRON_INFO("job ", job->id(), ' ', job->service());
+
+            batch.at = at;
+            batch.ids.push_back(job->id());
+            batch.deadlines.push_back(job->deadline());
+            batch.payload.push_back(render(job->payload(), at, frame_));
+
+            if(limit->second <= batch.ids.size()) submit(job->service(), batch);
+        };
+
+    table->schedule.match(tm, due_);
+
+    try
+    {
+        /* bit order is table order (priority) */
+        for(std::size_t w = 0; w < due_.size(); ++w)
+        {
+            for(auto word = due_[w]; word; word &= word - 1)
+            {
+                fire(table->jobs[w * Schedule::WORD_BITS + std::size_t(__builtin_ctzll(word))]);
+            }
+        }
+
+        flush();
+    }
+    catch(...)
+    {
+        /* reserved jobs of unsent batches would never fire again */
+        for(auto &i : batchMap_)
+        {
+            dispatcher_->cancel(i.second.ids);
+            i.second.clear();
+        }
+
+        throw;
+    }
+
+    /* table is not referenced past this point */
+    table_.quiescent();
+}
+
+void Cron::dispatch(const Job &job, Clock::time_point at, std::string &frame)
+{
+    CRON_INFO("job ", job.id(), ' ', job.service());
+
+    submit(
+        job.id(),
+        job.service(),
+        job.overlap(),
+        job.deadline(),
+        at,
+        render(job.payload(), at, frame));
+}
+
+void Cron::submit(
+    const std::string &id,
+    const std::string &service,
+    Overlap overlap,
+    std::chrono::milliseconds deadline,
+    Clock::time_point at,
+    const std::string &payload)
+{
+    /* copies, job table version may be gone by the time it is sent */
+    dispatcher_->submit(
+        service,
+        id,
+        overlap,
+        [this, id, service, deadline, at, payload]()
+        {
+            send(id, service, deadline, at, payload);
+        });
+}
+
+void Cron::send(
+    const std::string &id,
+    const std::string &service,
+    std::chrono::milliseconds deadline,
+    Clock::time_point at,
+    const std::string &payload)
+{
+    const auto dispatched = time_.now();
+
+    if(late(id, service, deadline, at, dispatched)) return;
+
+    try
+    {
+        dispatch(service, payload, at);
+    }
+    catch(...)
+    {
+        record(id, service, at, dispatched, FireRecord::Failed);
+        throw;
+    }
+
+    record(id, service, at, dispatched, FireRecord::Ok);
+}
+
+void Cron::submit(const std::string &service, Batch &batch)
+{
+    CRON_INFO("batch ", service, ' ', uint64_t(batch.ids.size()));
+
+    auto keys = batch.ids;
+
+    dispatcher_->submit(
+        service,
+        std::move(keys),
+        [this, service, request = std::move(batch)]() mutable
+        {
+            send(service, request);
+        });
+
+    batch.clear();
+}
+
+void Cron::send(const std::string &service, Batch &batch)
+{
+    const auto dispatched = time_.now();
+
+    /* drop late jobs, keep order of the rest */
+    std::size_t size = 0;
+
+    for(std::size_t i = 0; i < batch.ids.size(); ++i)
     {
-        for(const auto &job : jobSeq.second)
+        if(late(batch.ids[i], service, batch.deadlines[i], batch.at, dispatched)) continue;
+
+        if(size != i)
         {
-            if(job.expired(at)) dispatch(job);
+            batch.ids[size] = std::move(batch.ids[i]);
+            batch.deadlines[size] = batch.deadlines[i];
+            batch.payload[size] = std::move(batch.payload[i]);
         }
+
+        ++size;
     }
 
-    const auto delta = std::chrono::system_clock::now() - at;
+    batch.ids.resize(size);
+    batch.deadlines.resize(size);
+    batch.payload.resize(size);
+
+    if(batch.ids.empty()) return;
+
+    const auto failed =
+        [&]()
+        {
+            for(const auto &id : batch.ids)
+            {
+                record(id, service, batch.at, dispatched, FireRecord::Failed);
+            }
+        };
+
+    PayloadSeq replyPayload;
+
+    try
+    {
+        bool sent = false;
+
+        replyPayload = brokers_->exec(service, batch.payload, jitter(batch.at, sent));
+
+        /* broker status followed by worker status per job */
+        ENSURE(!replyPayload.empty(), RuntimeError);
+        ENSURE(MDP::Broker::Signature::statusSucess == replyPayload[0], RuntimeError);
+        ENSURE(batch.ids.size() + 1 == replyPayload.size(), RuntimeError);
+    }
+    catch(...)
+    {
+        failed();
+        throw;
+    }
 
-    if(std::chrono::milliseconds{1000} > delta)
+    /* worker status per job, a failed job does not fail the others */
+    for(std::size_t i = 0; i < batch.ids.size(); ++i)
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds{1000} - delta);
+        const auto &status = replyPayload[i + 1];
+
+        if(MDP::Broker::Signature::statusSucess == status)
+        {
+            CRON_DEBUG(batch.ids[i], ' ', status);
+            record(batch.ids[i], service, batch.at, dispatched, FireRecord::Ok);
+            continue;
+        }
+
+        CRON_ERROR("batch ", batch.ids[i], ' ', service, " failed ", status);
+        ++batchFailedCount_;
+        record(batch.ids[i], service, batch.at, dispatched, FireRecord::Failed);
     }
+
+    ++batchCount_;
+    batchJobCount_ += batch.ids.size();
+}
+
+const std::string &Cron::render(
+    const PayloadTemplate &payload,
+    Clock::time_point at,
+    std::string &frame)
+{
+    using namespace std::chrono;
+
+    if(payload.isStatic()) return payload.text();
+
+    payload.render(
+        frame,
+        {
+            uint64_t(duration_cast<milliseconds>(at.time_since_epoch()).count()),
+            ++fireSeq_
+        });
+
+    return frame;
+}
+
+bool Cron::late(
+    const std::string &id,
+    const std::string &service,
+    std::chrono::milliseconds deadline,
+    Clock::time_point at,
+    Clock::time_point now)
+{
+    if(!deadline.count() || now <= at + deadline) return false;
+
+    CRON_INFO("late ", id, ' ', service);
+    ++lateCount_;
+    record(id, service, at, now, FireRecord::Late);
+    return true;
 }
 
-void Cron::dispatch(const Job &job)
+void Cron::record(
+    const std::string &id,
+    const std::string &service,
+    Clock::time_point scheduled,
+    Clock::time_point dispatched,
+    FireRecord::Outcome outcome)
 {
-    TRACE(TraceLevel::Info, "job ", job);
+    if(!ring_) return;
+
+    FireRecord record;
+
+    record.scheduledNs = nanoseconds(scheduled);
+    record.dispatchedNs = nanoseconds(dispatched);
+    record.completedNs = nanoseconds(time_.now());
+    record.outcome = outcome;
+    record.reserved = 0;
+    copy(record.service, service);
+    copy(record.job, id);
 
-    Client client;
+    ring_->push(record);
+}
+
+void Cron::dispatch(const std::string &service, const std::string &payload, Clock::time_point at)
+{
+    bool sent = false;
 
-    const auto replyPayload =
-        client.exec(brokerAddr_, job.service(), {job.payload().dump()});
+    const auto replyPayload = brokers_->exec(service, {payload}, jitter(at, sent));
 
     ENSURE(2 == int(replyPayload.size()), RuntimeError);
     ENSURE(MDP::Broker::Signature::statusSucess == replyPayload[0], RuntimeError);
 }
 
-void Cron::exec()
+Brokers::Sent Cron::jitter(Clock::time_point at, bool &sent)
 {
-    while(!stopExec_)
-    {
-        TRACE(TraceLevel::Info, "stopMonitor_ ", stopMonitor_);
-        stopMonitor_ = false;
-
-        try
+    /* called by one sender at a time, in the order of sends */
+    return
+        [this, at, &sent]()
         {
-            EventSeqQueue queue;
+            if(sent) return;
 
-            auto r =
-                std::async(
-                    std::launch::async,
-                    [this, &queue]()
-                    {
-                        monitor(queue);
-                    });
+            sent = true;
+            jitter_.add(std::chrono::duration_cast<std::chrono::microseconds>(time_.now() - at));
+        };
+}
 
-            /* in case current thread throws make sure async task
-             * is terminated otherwise deadlock will occur */
-            StopGuard stopGuard{stopMonitor_};
+void Cron::wait(Clock::time_point until)
+{
+    using namespace std::chrono;
+
+    bool wakeUp;
+
+    const auto margin = lowJitter_ ? SPIN : microseconds{0};
+    const auto timeout =
+        std::max(duration_cast<microseconds>(until - time_.now()) - margin, microseconds{0});
+
+    if(wakeUp_.pop(wakeUp, timeout)) return;
+
+    /* condition variable wake up is late by scheduler latency */
+    while(lowJitter_ && time_.now() < until);
+}
+
+void Cron::realTime()
+{
+    TRACE(TraceLevel::Info, "low jitter mode");
+
+    setTimerSlack(TIMER_SLACK_NSECS);
+    if(!cpus_.empty()) pinThread(cpus_);
+    if(priority_) setFifo(priority_);
+    lockMemory();
+    prefaultStack(PREFAULT_STACK);
+}
+
+void Cron::normal()
+{
+    if(!lowJitter_) return;
 
-            /* delay dispatching to timeout failed jobs (on restart) */
-            std::this_thread::sleep_for(std::chrono::seconds{1});
+    setNormal();
+    pinThread(normalCpus_);
+}
+
+void Cron::expire(Clock::time_point at)
+{
+    std::vector<std::pair<Wheel::Handle, OneShot>> oneShotSeq;
+
+    {
+        std::lock_guard<std::mutex> lock{wheelMutex_};
 
-            while(!stopExec_)
+        wheel_.advance(
+            toTick(at),
+            [&oneShotSeq](Wheel::Handle handle, OneShot &&oneShot)
             {
-                EventSeq eventSeq;
+                oneShotSeq.emplace_back(handle, std::move(oneShot));
+            });
+    }
 
-                if(queue.pop(eventSeq, std::chrono::milliseconds{50}))
-                {
-                    update(eventSeq);
-                }
+    /* removed from the wheel, a failure must not lose the rest */
+    for(const auto &i : oneShotSeq)
+    {
+        const auto &oneShot = i.second;
+        const auto id = oneShotId(i.first);
 
-                dispatch(Clock::now());
-            }
+        CRON_INFO("one-shot ", id, ' ', *oneShot.service);
 
-            /* if async thread throws exception it will be propagated on get() */
-            r.get();
+        try
+        {
+            std::string frame;
+
+            submit(
+                id,
+                *oneShot.service,
+                Overlap::Allow,
+                std::chrono::milliseconds{0},
+                oneShot.at,
+                render(oneShot.payload, oneShot.at, frame));
         }
         catch(const std::exception &except)
         {
-            TRACE(TraceLevel::Error, except.what());
+            CRON_ERROR("one-shot ", id, ' ', except.what());
+            record(id, *oneShot.service, oneShot.at, time_.now(), FireRecord::Failed);
         }
         catch(...)
         {
-            TRACE(TraceLevel::Error, "unsupported exception");
-            stopExec_ = true;
-            stopMonitor_ = true;
+            CRON_ERROR("one-shot ", id, " unsupported exception");
+            record(id, *oneShot.service, oneShot.at, time_.now(), FireRecord::Failed);
         }
     }
 }
 
-void Cron::monitor(EventSeqQueue &queue)
+const std::string *Cron::intern(const std::string &service)
 {
-    while(!stopMonitor_)
-    {
-        try
-        {
-            using EventType = Monitor::EventType;
+    /* caller holds wheelMutex_, elements are stable */
+    return &*serviceNames_.insert(service).first;
+}
 
-            Monitor monitor;
+Clock::time_point Cron::deadline(Clock::time_point tick)
+{
+    std::lock_guard<std::mutex> lock{wheelMutex_};
 
-            monitor.add(
-                basePath_,
-                /* modified inside watched directory */
-                EventType::CloseWrite
-                /* create inside watched directory (link to file) */
-                | EventType::Create
-                /* moved from watched directory */
+    if(wheel_.empty()) return tick;
+
+    const auto expiry = wheelOrigin_ + std::chrono::milliseconds{wheel_.expiry()};
+
+    return std::min(tick, expiry);
+}
+
+auto Cron::toTick(Clock::time_point at) const -> Wheel::Tick
+{
+    using namespace std::chrono;
+
+    if(wheelOrigin_ >= at) return 0;
+    return Wheel::Tick(duration_cast<milliseconds>(at - wheelOrigin_).count());
+}
+
+void Cron::exec()
+{
+    ENSURE(brokers_, RuntimeError);
+
+    using namespace std::chrono;
+
+    /* predecessor's next tick, none on cold start */
+    Clock::time_point resume;
+
+    if(!handoverPath_.empty())
+    {
+        auto predecessor = HandoverChannel::connect(handoverPath_);
+
+        if(predecessor) resume = takeover(*predecessor);
+    }
+
+    while(!stopExec_)
+    {
+        TRACE(TraceLevel::Info, "stopMonitor_ ", stopMonitor_);
+        stopMonitor_ = false;
+
+        try
+        {
+            handover_ = false;
+            successor_.reset();
+            stopPublish_ = false;
+
+            auto p =
+                std::async(
+                    std::launch::async,
+                    [this]()
+                    {
+                        normal();
+                        publish();
+                    });
+
+            auto r =
+                std::async(
+                    std::launch::async,
+                    [this]()
+                    {
+                        normal();
+                        monitor();
+                    });
+
+            /* in case current thread throws make sure async task
+             * is terminated otherwise deadlock will occur */
+            StopGuard stopGuard{stopMonitor_};
+            StopGuard stopPublishGuard{stopPublish_};
+
+            /* standby: schedule is kept warm, nothing is fired */
+            const auto leaseTick = standby();
+
+            stopAdmin_ = false;
+
+            auto a =
+                std::async(
+                    std::launch::async,
+                    [this]()
+                    {
+                        normal();
+                        admin();
+                    });
+
+            stopHandover_ = false;
+
+            auto h =
+                std::async(
+                    std::launch::async,
+                    [this]()
+                    {
+                        normal();
+                        handover();
+                    });
+
+            StopGuard stopAdminGuard{stopAdmin_};
+            StopGuard stopHandoverGuard{stopHandover_};
+
+            /* recurring jobs are evaluated at whole seconds */
+            auto tick = time_point_cast<seconds>(time_.now()) + seconds{1};
+
+            if(Clock::time_point{} != resume)
+            {
+                /* predecessor stopped right before it */
+                tick = time_point_cast<seconds>(resume);
+                resume = Clock::time_point{};
+            }
+            else if(Clock::time_point{} != leaseTick)
+            {
+                /* previous lease holder fired up to it */
+                tick = time_point_cast<seconds>(leaseTick) + seconds{1};
+            }
+            else
+            {
+                /* delay dispatching to timeout failed jobs (on restart) */
+                std::this_thread::sleep_for(seconds{1});
+                tick = time_point_cast<seconds>(time_.now()) + seconds{1};
+            }
+
+            /* taken over while stuck, back to standby */
+            bool leaseLost = false;
+
+            while(!stopExec_ && !handover_ && !leaseLost)
+            {
+                wait(deadline(tick));
+
+                const auto now = time_.now();
+
+                expire(now);
+
+                /* clock stepped back or jumped forward, resync */
+                if(tick > now + seconds{1} || now - tick > CATCH_UP)
+                {
+                    TRACE(TraceLevel::Error, "clock jump, resync");
+                    tick = time_point_cast<seconds>(now);
+                }
+
+                for(; !stopExec_ && tick <= now; tick += seconds{1})
+                {
+                    /* recorded first, a tick is never fired twice */
+                    if(lease_ && !lease_->renew(tick.time_since_epoch().count()))
+                    {
+                        leaseLost = true;
+                        break;
+                    }
+
+                    dispatch(tick);
+                }
+            }
+
+            LOG(TraceLevel::Info, "jitter ", jitter_);
+
+            stopMonitor_ = true;
+            stopAdmin_ = true;
+            stopPublish_ = true;
+            stopHandover_ = true;
+
+            /* if async thread throws exception it will be propagated on get() */
+            r.get();
+            a.get();
+            p.get();
+            h.get();
+
+            if(handover_)
+            {
+                /* predecessor sends nothing past its state,
+                 * tick and admin threads are stopped, nothing is submitted */
+                dispatcher_->drain();
+
+                /* on failure monitor() takes its descriptor back */
+                successor_->send(state(tick), monitorFd_);
+
+                TRACE(TraceLevel::Info, "handed over at ", epochMs(tick));
+
+                if(-1 != monitorFd_) ::close(monitorFd_);
+                monitorFd_ = -1;
+                successor_.reset();
+                stopExec_ = true;
+            }
+        }
+        catch(const std::exception &except)
+        {
+            TRACE(TraceLevel::Error, except.what());
+        }
+        catch(...)
+        {
+            TRACE(TraceLevel::Error, "unsupported exception");
+            stopExec_ = true;
+            stopMonitor_ = true;
+            stopAdmin_ = true;
+            stopPublish_ = true;
+            stopHandover_ = true;
+        }
+    }
+}
+
+Clock::time_point Cron::standby()
+{
+    using namespace std::chrono;
+
+    if(!lease_ || lease_->held()) return {};
+
+    if(!lease_->acquire())
+    {
+        TRACE(TraceLevel::Info, "standby");
+
+        while(!stopExec_ && !lease_->acquire()) std::this_thread::sleep_for(LEASE_POLL);
+    }
+
+    ENSURE(lease_->held(), RuntimeError);
+
+    const Clock::time_point tick{seconds{lease_->tick()}};
+
+    TRACE(TraceLevel::Info, "active, lease tick ", epochMs(tick));
+
+    if(!statePath_.empty())
+    {
+        /* admin jobs of the previous holder, otherwise ones in memory
+         * (received on handover) are kept */
+        std::lock_guard<std::mutex> lock{tableMutex_};
+
+        adminJobMap_.clear();
+        load();
+        changed();
+    }
+
+    /* no tick recorded or too old to catch up */
+    if(Clock::time_point{} == tick || time_.now() - tick > CATCH_UP) return {};
+    return tick;
+}
+
+void Cron::publish()
+{
+    while(!stopPublish_)
+    {
+        try
+        {
+            std::unique_ptr<const JobTable> table;
+
+            {
+                std::unique_lock<std::mutex> lock{tableMutex_};
+
+                tableCond_.wait_for(
+                    lock,
+                    std::chrono::milliseconds{500},
+                    [this](){return dirty_;});
+
+                /* changes made meanwhile are coalesced into one version */
+                if(dirty_)
+                {
+                    table = snapshot();
+                    dirty_ = false;
+                }
+            }
+
+            if(table)
+            {
+                TRACE(TraceLevel::Debug, "publish ", table->jobs.size(), " jobs");
+                table_.publish(std::move(table));
+            }
+            else
+            {
+                table_.reclaim();
+            }
+        }
+        catch(const std::exception &except)
+        {
+            TRACE(TraceLevel::Error, except.what());
+        }
+        catch(...)
+        {
+            TRACE(TraceLevel::Error, "unsupported exception");
+            stopExec_ = true;
+        }
+    }
+}
+
+void Cron::changed()
+{
+    /* caller holds tableMutex_ */
+    dirty_ = true;
+    tableCond_.notify_one();
+}
+
+auto Cron::snapshot() const -> std::unique_ptr<const JobTable>
+{
+    /* caller holds tableMutex_ (or is the only thread) */
+    auto table = std::make_unique<JobTable>();
+
+    table->adminJobSeq.reserve(adminJobMap_.size());
+
+    for(const auto &i : jobFileMap_)
+    {
+        table->jobSeqSeq.push_back(i.second.jobSeq);
+
+        for(const auto &job : *i.second.jobSeq) table->jobs.push_back(&job);
+    }
+
+    for(const auto &i : adminJobMap_)
+    {
+        table->adminJobSeq.push_back(i.second.job);
+        table->jobs.push_back(i.second.job.get());
+    }
+
+    std::stable_sort(
+        std::begin(table->jobs), std::end(table->jobs),
+        [](const Job *a, const Job *b){return a->priority() > b->priority();});
+
+    table->schedule = Schedule{table->jobs};
+
+    return table;
+}
+
+void Cron::simulate(Clock::time_point from, Clock::time_point to, bool count)
+{
+    Simulation simulation{table_.read()->jobs};
+    VirtualTime time{from};
+    std::vector<uint64_t> countSeq(simulation.jobs().size(), 0);
+    uint64_t total = 0;
+
+    simulation.run(
+        time,
+        to,
+        [&](Clock::time_point at, std::size_t index)
+        {
+            ++total;
+
+            if(count)
+            {
+                ++countSeq[index];
+                return;
+            }
+
+            const auto tm = TimeSource::localtime(at);
+
+            std::cout
+                << std::put_time(&tm, "%F %T %z")
+                << ' ' << *simulation.jobs()[index] << '\n';
+        });
+
+    if(count)
+    {
+        for(std::size_t i = 0; i < countSeq.size(); ++i)
+        {
+            std::cout << countSeq[i] << ' ' << *simulation.jobs()[i] << '\n';
+        }
+    }
+
+    std::cout << "total " << total << std::endl;
+}
+
+void Cron::monitor()
+{
+    /* set when watched tree was swapped, next monitor loads it */
+    bool swapped = false;
+
+    while(!stopMonitor_)
+    {
+        try
+        {
+            using EventType = Monitor::EventType;
+
+            const auto inherited = monitorFd_;
+
+            monitorFd_ = -1;
+
+            std::unique_ptr<Monitor> monitor{
+                -1 == inherited ? new Monitor{} : new Monitor{inherited}};
+
+            /* existing watch is returned for inherited descriptor */
+            monitor->add(
+                basePath_,
+                /* modified inside watched directory */
+                EventType::CloseWrite
+                /* create inside watched directory (link to file) */
+                | EventType::Create
+                /* moved from watched directory */
                 | EventType::MovedFrom
                 /* moved into watched directory (potentially overwriting) */
                 | EventType::MovedTo
-                /* watched directory moved (fatal) */
+                /* watched directory moved (swapped) */
                 | EventType::MoveSelf
                 /* file deleted inside watched directory */
                 | EventType::Delete
-                /* watched directory deleted (fatal) */
+                /* watched directory deleted (swapped) */
                 | EventType::DeleteSelf);
 
+            /* symbolic link to directory is swapped in its own directory,
+             * (re)created or renamed over */
+            if(isLink(basePath_))
+            {
+                monitor->add(parentPath(basePath_), EventType::Create | EventType::MovedTo);
+            }
+
+            /* changes seen by the other process are not queued anymore,
+             * new tree is watched before it is loaded, nothing is missed */
+            if(-1 != inherited || swapped || resolvePath(basePath_) != target_) rescan();
+
+            swapped = false;
+
             while(!stopMonitor_)
             {
-                const auto eventSeq = monitor.poll(Monitor::mSecs{500});
+                const auto eventSeq = monitor->poll(Monitor::mSecs{500});
+
+                /* parsed here, dispatcher only picks up new version */
+                if(eventSeq.empty() || !update(eventSeq)) continue;
+
+                /* queued events of the old tree go with the descriptor */
+                TRACE(TraceLevel::Info, basePath_, " swapped");
+                swapped = true;
+                break;
+            }
+
+            /* queued events go to successor */
+            if(handover_) monitorFd_ = monitor->release();
+        }
+        catch(const std::exception &except)
+        {
+            TRACE(TraceLevel::Error, except.what());
+            /* watched directory may be missing until swap completes */
+            std::this_thread::sleep_for(MONITOR_RETRY);
+        }
+        catch(...)
+        {
+            TRACE(TraceLevel::Error, "unsupported exception");
+            stopExec_ = true;
+        }
+    }
+}
 
-                if(!eventSeq.empty())
+void Cron::admin()
+{
+    /* served on every broker, admin does not depend on any single one */
+    std::vector<std::future<void>> workers;
+
+    for(const auto &address : brokers_->addresses())
+    {
+        workers.push_back(
+            std::async(
+                std::launch::async,
+                [this, address]()
                 {
-                    queue.push(std::move(eventSeq));
-                }
+                    adminWorker(address);
+                }));
+    }
+
+    /* if async thread throws exception it will be propagated on get() */
+    for(auto &worker : workers) worker.get();
+}
+
+void Cron::adminWorker(const std::string &address)
+{
+    while(!stopAdmin_)
+    {
+        try
+        {
+            Worker worker;
+
+            worker.exec(
+                address,
+                adminService_,
+                [this](const PayloadSeq &request)
+                {
+                    return admin(request);
+                },
+                stopAdmin_);
+        }
+        catch(const std::exception &except)
+        {
+            TRACE(TraceLevel::Error, except.what());
+        }
+        catch(...)
+        {
+            TRACE(TraceLevel::Error, "unsupported exception");
+            stopExec_ = true;
+        }
+    }
+}
+
+auto Cron::admin(const PayloadSeq &request) -> PayloadSeq
+{
+    /* invalid request must not take the worker down,
+     * report it back to the client instead */
+    try
+    {
+        ENSURE(1 == int(request.size()), RuntimeError);
+
+        return {admin(json::parse(request[0])).dump()};
+    }
+    catch(const std::exception &except)
+    {
+        TRACE(TraceLevel::Error, except.what());
+        return {json{{STATUS, FAILED}, {REASON, except.what()}}.dump()};
+    }
+}
+
+json Cron::admin(const json &request)
+{
+    ENSURE(request.is_object(), RuntimeError);
+    ENSURE(request.count(COMMAND), RuntimeError);
+    ENSURE(request[COMMAND].is_string(), RuntimeError);
+
+    const auto command = request[COMMAND].get<std::string>();
+
+    TRACE(TraceLevel::Debug, "admin ", command);
+
+    if(LIST == command)
+    {
+        json jobs = json::array();
+
+        std::lock_guard<std::mutex> lock{tableMutex_};
+
+        for(const auto &i : adminJobMap_)
+        {
+            jobs.push_back({{ID, i.first}, {JOB, i.second.input}});
+        }
+
+        std::lock_guard<std::mutex> wheelLock{wheelMutex_};
+
+        return {{STATUS, OK}, {JOBS, std::move(jobs)}, {TIMERS, wheel_.size()}};
+    }
+
+    if(STATS == command)
+    {
+        json jitter = json::array();
+
+        for(int i = 0; i < Histogram::BUCKETS; ++i)
+        {
+            const auto count = jitter_.count(i);
+
+            if(count) jitter.push_back({{BOUND, Histogram::bound(i)}, {COUNT, count}});
+        }
+
+        json brokers = json::array();
+
+        for(const auto &i : brokers_->stats())
+        {
+            brokers.push_back(
+                {
+                    {ADDRESS, i.address},
+                    {HEALTHY, i.healthy},
+                    {RTT_US, i.rtt.count()},
+                    {REQUESTS, i.requests},
+                    {FAILURES, i.failures},
+                    {BUSY, i.busy},
+                    {PENDING, i.pending}
+                });
+        }
+
+        const auto dispatcher = dispatcher_->stats();
+
+        return
+        {
+            {STATUS, OK},
+            {JITTER, std::move(jitter)},
+            {MAX, jitter_.max()},
+            {BATCHES, batchCount_.load()},
+            {BATCHED_JOBS, batchJobCount_.load()},
+            {BATCH_FAILED, batchFailedCount_.load()},
+            {LATE, lateCount_.load()},
+            {SKIPPED, dispatcher.skipped},
+            {DEFERRED, dispatcher.deferred},
+            {DROPPED, dispatcher.dropped},
+            {IN_FLIGHT, dispatcher.inFlight},
+            {BROKERS, std::move(brokers)}
+        };
+    }
+
+    if(SCHEDULE == command)
+    {
+        ENSURE(request.count(SERVICE), RuntimeError);
+        ENSURE(request[SERVICE].is_string(), RuntimeError);
+        ENSURE(request.count(PAYLOAD), RuntimeError);
+        ENSURE(request[PAYLOAD].is_array(), RuntimeError);
+
+        using namespace std::chrono;
+
+        int64_t atMs;
+
+        if(request.count(AT_MS))
+        {
+            atMs = request[AT_MS].get<int64_t>();
+        }
+        else
+        {
+            ENSURE(request.count(AFTER_MS), RuntimeError);
+
+            const auto afterMs = request[AFTER_MS].get<int64_t>();
+            const auto nowMs = epochMs(time_.now());
+
+            ENSURE(MAX_EPOCH_MS - nowMs >= afterMs, RuntimeError);
+            atMs = nowMs + afterMs;
+        }
+
+        ENSURE(0 <= atMs && MAX_EPOCH_MS >= atMs, RuntimeError);
+
+        const Clock::time_point at{milliseconds{atMs}};
+        const auto service = request[SERVICE].get<std::string>();
+        const auto tick = toTick(at);
+        Wheel::Handle handle;
+        bool wakeUp;
+
+        {
+            std::lock_guard<std::mutex> lock{wheelMutex_};
+
+            /* range checked before the payload is compiled */
+            ENSURE(wheel_.fits(tick), RuntimeError);
+
+            handle = wheel_.vacant();
+            wakeUp = wheel_.empty() || wheel_.expiry() > tick;
+
+            /* timer id is its job_id, known before insert */
+            ENSURE(
+                handle
+                == wheel_.insert(
+                    tick,
+                    OneShot{intern(service), PayloadTemplate{request[PAYLOAD], oneShotId(handle)}, at}),
+                RuntimeError);
+        }
+
+        /* exec() may sleep past new expiry */
+        if(wakeUp) wakeUp_.push(true);
+
+        return {{STATUS, OK}, {TIMER, handle}};
+    }
+
+    if(CANCEL == command)
+    {
+        ENSURE(request.count(TIMER), RuntimeError);
+
+        const auto handle = request[TIMER].get<Wheel::Handle>();
+
+        std::lock_guard<std::mutex> lock{wheelMutex_};
+
+        ENSURE(wheel_.cancel(handle), RuntimeError);
+
+        return {{STATUS, OK}};
+    }
+
+    ENSURE(request.count(ID), RuntimeError);
+    ENSURE(request[ID].is_string(), RuntimeError);
+
+    const auto id = request[ID].get<std::string>();
+
+    if(ADD == command)
+    {
+        ENSURE(request.count(JOB), RuntimeError);
+
+        const auto &input = request[JOB];
+        /* parse outside of the lock, it throws on invalid job */
+        auto job = std::make_shared<const Job>(parseJob(id, id, input));
+
+        AdminState state;
+
+        {
+            std::lock_guard<std::mutex> lock{tableMutex_};
+
+            adminJobMap_[id] = AdminJob{input, std::move(job)};
+            state = adminState();
+            changed();
+        }
+
+        save(state);
+    }
+    else if(REMOVE == command)
+    {
+        AdminState state;
+
+        {
+            std::lock_guard<std::mutex> lock{tableMutex_};
+
+            ENSURE(adminJobMap_.erase(id), RuntimeError);
+            state = adminState();
+            changed();
+        }
+
+        save(state);
+    }
+    else if(FIRE == command)
+    {
+        std::shared_ptr<const Job> job;
+
+        {
+            std::lock_guard<std::mutex> lock{tableMutex_};
+
+            const auto i = adminJobMap_.find(id);
+
+            ENSURE(adminJobMap_.end() != i, RuntimeError);
+            job = i->second.job;
+        }
+
+        std::string frame;
+
+        dispatch(*job, time_.now(), frame);
+    }
+    else
+    {
+        ENSURE(false, RuntimeError);
+    }
+
+    return {{STATUS, OK}};
+}
+
+void Cron::load()
+{
+    if(statePath_.empty()) return;
+    if(!access(statePath_, AccessMode::Exist | AccessMode::Read)) return;
+
+    json input;
+    std::ifstream{statePath_} >> input;
+
+    load(input);
+}
+
+void Cron::load(const json &input)
+{
+    ENSURE(input.is_array(), RuntimeError);
+
+    for(const auto &i : input)
+    {
+        ENSURE(i.count(ID), RuntimeError);
+        ENSURE(i.count(JOB), RuntimeError);
+
+        const auto id = i[ID].get<std::string>();
+        auto job = std::make_shared<const Job>(parseJob(id, id, i[JOB]));
+
+        LOG(TraceLevel::Info, "admin ", *job);
+        adminJobMap_[id] = AdminJob{i[JOB], std::move(job)};
+    }
+}
+
+auto Cron::adminState() -> AdminState
+{
+    /* caller holds tableMutex_ */
+    if(statePath_.empty()) return {0, {}};
+
+    return {++stateVersion_, adminJobs()};
+}
+
+void Cron::save(const AdminState &state)
+{
+    if(statePath_.empty()) return;
+
+    std::lock_guard<std::mutex> lock{saveMutex_};
+
+    /* a later change is written already */
+    if(savedVersion_ >= state.version) return;
+
+    replaceFile(statePath_, state.jobs.dump());
+    savedVersion_ = state.version;
+}
+
+json Cron::adminJobs() const
+{
+    /* caller holds tableMutex_ */
+    json output = json::array();
+
+    for(const auto &i : adminJobMap_)
+    {
+        output.push_back({{ID, i.first}, {JOB, i.second.input}});
+    }
+
+    return output;
+}
+
+void Cron::handover()
+{
+    if(handoverPath_.empty()) return;
+
+    while(!stopHandover_)
+    {
+        try
+        {
+            HandoverListener listener{handoverPath_};
+
+            while(!stopHandover_)
+            {
+                auto channel = listener.accept(HANDOVER_POLL);
+
+                if(!channel) continue;
+
+                const auto request = channel->receive();
+
+                ENSURE(request.is_object(), RuntimeError);
+                ENSURE(request.count(COMMAND), RuntimeError);
+                ENSURE(HANDOVER == request[COMMAND].get<std::string>(), RuntimeError);
+
+                TRACE(TraceLevel::Info, "handover requested");
+
+                successor_ = std::move(channel);
+                handover_ = true;
+                /* tick loop stops before its next tick */
+                wakeUp_.push(true);
+                return;
             }
         }
         catch(const std::exception &except)
@@ -263,4 +1561,100 @@ void Cron::monitor(EventSeqQueue &queue)
     }
 }
 
+json Cron::state(Clock::time_point tick)
+{
+    json timers = json::array();
+
+    {
+        std::lock_guard<std::mutex> lock{wheelMutex_};
+
+        wheel_.forEach(
+            [&timers](Wheel::Handle handle, const OneShot &oneShot)
+            {
+                timers.push_back(
+                    {
+                        {TIMER, handle},
+                        {SERVICE, *oneShot.service},
+                        {PAYLOAD, oneShot.payload.source()},
+                        {AT_MS, epochMs(oneShot.at)}
+                    });
+            });
+    }
+
+    json jobs;
+
+    {
+        std::lock_guard<std::mutex> lock{tableMutex_};
+
+        jobs = adminJobs();
+    }
+
+    return
+    {
+        {TICK_MS, epochMs(tick)},
+        {JOBS, std::move(jobs)},
+        {TIMERS, std::move(timers)},
+        {SEQ, fireSeq_.load()}
+    };
+}
+
+Clock::time_point Cron::takeover(HandoverChannel &predecessor)
+{
+    predecessor.send({{COMMAND, HANDOVER}});
+
+    int fd = -1;
+    const auto input = predecessor.receive(&fd);
+
+    /* predecessor has stopped, it is not firing anymore */
+    monitorFd_ = fd;
+
+    ENSURE(input.count(TICK_MS), RuntimeError);
+    ENSURE(input.count(JOBS), RuntimeError);
+    ENSURE(input.count(TIMERS), RuntimeError);
+    ENSURE(input.count(SEQ), RuntimeError);
+
+    AdminState state;
+
+    {
+        std::lock_guard<std::mutex> lock{tableMutex_};
+
+        adminJobMap_.clear();
+        load(input[JOBS]);
+        state = adminState();
+        dirty_ = false;
+        table_.publish(snapshot());
+    }
+
+    save(state);
+
+    {
+        std::lock_guard<std::mutex> lock{wheelMutex_};
+
+        for(const auto &i : input[TIMERS])
+        {
+            const Clock::time_point at{std::chrono::milliseconds{i[AT_MS].get<int64_t>()}};
+            const auto handle = i[TIMER].get<Wheel::Handle>();
+
+            /* under the same handle, clients may still cancel it */
+            const auto inserted =
+                wheel_.insert(
+                    handle,
+                    toTick(at),
+                    OneShot{
+                        intern(i[SERVICE].get<std::string>()),
+                        PayloadTemplate{json::parse(i[PAYLOAD].get<std::string>()), oneShotId(handle)},
+                        at});
+
+            ENSURE(inserted, RuntimeError);
+        }
+    }
+
+    fireSeq_ = input[SEQ].get<uint64_t>();
+
+    const Clock::time_point tick{std::chrono::milliseconds{input[TICK_MS].get<int64_t>()}};
+
+    TRACE(TraceLevel::Info, "taken over at ", epochMs(tick));
+    return tick;
+}
+
 } /* cron */
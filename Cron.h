@@ -2,68 +2,310 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
-#include "AtValue.h"
+#include "Brokers.h"
+#include "Clock.h"
+#include "Dispatcher.h"
+#include "FireRing.h"
+#include "Handover.h"
+#include "Histogram.h"
+#include "Job.h"
+#include "Lease.h"
 #include "Monitor.h"
 #include "Queue.h"
+#include "RealTime.h"
+#include "Schedule.h"
+#include "Rcu.h"
+#include "TimingWheel.h"
+#include "fs.h"
 #include "json.h"
 
 namespace cron {
 
-using Clock = std::chrono::system_clock;
-
-class Job
-{
-protected:
-    /* canonical filename path - the job comes from,
-     * will be used to remove job in case file is deleted/moved */
-    std::string path_;
-    AtValue atValue_;
-    std::string service_;
-    json payload_;
-
-    friend
-    Job parseJob(std::string path, const json &);
-public:
-    Job(std::string path, AtValue atValue, std::string service, json payload):
-        path_{std::move(path)},
-        atValue_{std::move(atValue)},
-        service_{std::move(service)},
-        payload_(std::move(payload))
-    {}
-
-    bool expired(Clock::time_point tp) const {return atValue_.expired(tp);}
-    const std::string &service() const {return service_;}
-    const json &payload() const {return payload_;}
-
-    friend
-    std::ostream &operator<< (std::ostream &, const Job &);
-};
-
 class Cron
 {
+public:
+    struct Config
+    {
+        /* equivalent brokers, admin service is served on each */
+        std::vector<std::string> brokers;
+        /* wait for a free sender of a broker before failing over to
+         * the next one, the reply is waited for however long it takes */
+        std::chrono::milliseconds brokerTimeout{1000};
+        std::string basePath;
+        std::string adminService;
+        /* admin jobs are persisted here if not empty */
+        std::string statePath;
+        /* services receiving due jobs of a tick in one request,
+         * up to value jobs per request */
+        std::map<std::string, std::size_t> batch;
+        /* threads sending requests, 0 - sent by the thread firing them
+         * (job overlap policies and service in-flight limits apply either way) */
+        std::size_t dispatchThreads = 0;
+        /* in-flight request maximum per service */
+        std::map<std::string, std::size_t> inFlight;
+        /* memory locking, tight wake ups, jitter reporting */
+        bool lowJitter = false;
+        /* tick, dispatch pool and broker sender thread cpus (low jitter),
+         * not pinned if empty */
+        CpuSeq cpus;
+        /* SCHED_FIFO priority of the same threads (low jitter), 0 - not used */
+        int priority = 0;
+        /* shared memory segment firings are published to, none if empty */
+        std::string ring;
+        /* number of records kept, power of 2 */
+        uint32_t ringCapacity = 1 << 16;
+        /* unix socket a running predecessor is taken over from,
+         * successor is handed over to, none if empty */
+        std::string handoverPath;
+        /* standby until lease file lock is acquired, no lease if empty */
+        std::string leasePath;
+    };
+private:
     using JobSeq = std::vector<Job>;
-    using JobSeqMap = std::map<std::string, JobSeq>;
-    using EventSeq = Monitor::EventSeq;
-    using EventSeqQueue = Queue<EventSeq>;
+    using JobSeqPtr = std::shared_ptr<const JobSeq>;
+
+    /* jobs of a file, reused while the file is unchanged */
+    struct JobFile
+    {
+        FileId id;
+        JobSeqPtr jobSeq;
+    };
+
+    using JobFileMap = std::map<std::string, JobFile>;
+    using PayloadSeq = std::vector<std::string>;
+
+    /* job submitted through admin service,
+     * input is kept for listing and persistence */
+    struct AdminJob
+    {
+        json input;
+        std::shared_ptr<const Job> job;
+    };
+
+    using AdminJobMap = std::map<std::string, AdminJob>;
+
+    /* immutable version of the job table, dispatcher reads it
+     * without locking while the next version is being built */
+    struct JobTable
+    {
+        /* keep jobs alive as long as the version is in use */
+        std::vector<JobSeqPtr> jobSeqSeq;
+        std::vector<std::shared_ptr<const Job>> adminJobSeq;
+        /* highest priority first, file jobs in path order
+         * followed by admin jobs within a priority */
+        std::vector<const Job *> jobs;
+        /* columnar copy of jobs schedules, bit per jobs element */
+        Schedule schedule;
+    };
+
+    /* job fired once by the timing wheel */
+    struct OneShot
+    {
+        /* interned in serviceNames_ */
+        const std::string *service;
+        /* compiled with the timer id as job_id */
+        PayloadTemplate payload;
+        Clock::time_point at;
+    };
+
+    using Wheel = TimingWheel<OneShot>;
+
+    /* due jobs of one service packed in one request, frame per job,
+     * copied as the request may outlive the job table version */
+    struct Batch
+    {
+        /* scheduled time shared by the jobs */
+        Clock::time_point at;
+        /* reserved in dispatcher_ until the request completes */
+        Dispatcher::KeySeq ids;
+        std::vector<std::chrono::milliseconds> deadlines;
+        PayloadSeq payload;
+
+        void clear()
+        {
+            ids.clear();
+            deadlines.clear();
+            payload.clear();
+        }
+    };
+
+    using BatchLimitMap = std::map<std::string, std::size_t>;
+    using BatchMap = std::map<std::string, Batch>;
 
-    std::string brokerAddr_;
+    const TimeSource &time_;
+    /* null in simulation */
+    std::unique_ptr<Brokers> brokers_;
+    /* parent resolved only, if it is a symbolic link its target
+     * may be swapped (job file paths are kept) */
     std::string basePath_;
-    JobSeqMap jobSeqMap_;
+    /* basePath_ resolved as of last rescan(), used by monitor() only */
+    std::string target_;
+    std::string adminService_;
+    /* admin jobs are persisted here if not empty */
+    std::string statePath_;
+    BatchLimitMap batchLimitMap_;
+    /* per tick batches, reused */
+    BatchMap batchMap_;
+    std::atomic<uint64_t> batchCount_{0};
+    std::atomic<uint64_t> batchJobCount_{0};
+    /* batched jobs the worker reported failed */
+    std::atomic<uint64_t> batchFailedCount_{0};
+    /* jobs dropped past their deadline */
+    std::atomic<uint64_t> lateCount_{0};
+    bool lowJitter_;
+    /* constructing thread cpus before realTime() */
+    CpuSeq normalCpus_;
+    CpuSeq cpus_;
+    int priority_;
+    /* sequence number of templated payload dispatch */
+    std::atomic<uint64_t> fireSeq_{0};
+    /* templated payload frame of the tick thread, capacity is reused */
+    std::string frame_;
+    /* due jobs bitmap of the tick thread, capacity is reused */
+    Schedule::Bitmap due_;
+    /* delay of requests going out past their firing time */
+    Histogram jitter_;
+    /* held by the active instance, may be null */
+    std::unique_ptr<Lease> lease_;
+    /* firing records for external observers, may be null */
+    std::unique_ptr<FireRing> ring_;
+    /* guards writer side of the job table
+     * (jobFileMap_, adminJobMap_, dirty_) */
+    std::mutex tableMutex_;
+    std::condition_variable tableCond_;
+    /* writer side changed since last published version */
+    bool dirty_ = false;
+    JobFileMap jobFileMap_;
+    AdminJobMap adminJobMap_;
+    /* admin jobs change count (tableMutex_) */
+    uint64_t stateVersion_ = 0;
+    /* serializes state file writes */
+    std::mutex saveMutex_;
+    uint64_t savedVersion_ = 0;
+    /* published version, read by dispatcher */
+    Rcu<JobTable> table_;
+    /* wakes up exec() before its deadline */
+    Queue<bool> wakeUp_;
+    /* guards wheel_, shared by admin and dispatch threads */
+    std::mutex wheelMutex_;
+    /* wheel_ ticks are milliseconds since wheelOrigin_ */
+    Clock::time_point wheelOrigin_;
+    Wheel wheel_;
+    /* one-shot services, few and shared by many timers, never erased */
+    std::unordered_set<std::string> serviceNames_;
     std::atomic<bool> stopMonitor_{false};
+    std::atomic<bool> stopAdmin_{false};
+    std::atomic<bool> stopPublish_{false};
     std::atomic<bool> stopExec_{false};
+    std::atomic<bool> stopHandover_{false};
+    std::string handoverPath_;
+    /* successor asked for handover, tick loop stops */
+    std::atomic<bool> handover_{false};
+    /* set by handover thread, used by exec() once it is joined */
+    std::unique_ptr<HandoverChannel> successor_;
+    /* inotify descriptor inherited from predecessor (taken by monitor())
+     * or released by monitor() for successor, -1 if none */
+    int monitorFd_ = -1;
+    /* null in simulation, declared last to be destroyed first:
+     * pending requests are sent while the rest is still alive */
+    std::unique_ptr<Dispatcher> dispatcher_;
 
     void update(const std::string &path);
-    void update(const Monitor::EventSeq &);
+    /* true if basePath_ target was swapped (or lost),
+     * rest of the events are stale and skipped */
+    bool update(const Monitor::EventSeq &);
     void dispatch(std::chrono::system_clock::time_point);
-    void dispatch(const Job &);
-    void monitor(EventSeqQueue &);
+    void dispatch(const Job &, Clock::time_point at, std::string &frame);
+    void dispatch(const std::string &service, const std::string &payload, Clock::time_point at);
+    /* records delay past at when the request goes out, once,
+     * a failover resend is not counted again */
+    Brokers::Sent jitter(Clock::time_point at, bool &sent);
+    /* batch is moved to the request */
+    void submit(const std::string &service, Batch &);
+    void send(const std::string &service, Batch &);
+    /* through dispatcher_, payload is sent as is */
+    void submit(
+        const std::string &id,
+        const std::string &service,
+        Overlap,
+        std::chrono::milliseconds deadline,
+        Clock::time_point at,
+        const std::string &payload);
+    void send(
+        const std::string &id,
+        const std::string &service,
+        std::chrono::milliseconds deadline,
+        Clock::time_point at,
+        const std::string &payload);
+    /* true (job is dropped and counted) if past deadline, 0 - none */
+    bool late(
+        const std::string &id,
+        const std::string &service,
+        std::chrono::milliseconds deadline,
+        Clock::time_point at,
+        Clock::time_point now);
+    void record(
+        const std::string &id,
+        const std::string &service,
+        Clock::time_point scheduled,
+        Clock::time_point dispatched,
+        FireRecord::Outcome);
+    const std::string &render(const PayloadTemplate &, Clock::time_point at, std::string &frame);
+    void expire(Clock::time_point);
+    /* stable pointer to equal service name */
+    const std::string *intern(const std::string &service);
+    Clock::time_point deadline(Clock::time_point tick);
+    Wheel::Tick toTick(Clock::time_point) const;
+    void monitor();
+    /* reload every job file of basePath_, drop jobs of missing ones,
+     * the whole tree goes in one version, unchanged files are not parsed */
+    void rescan();
+    void handover();
+    json state(Clock::time_point tick);
+    /* returns predecessor's next tick */
+    Clock::time_point takeover(HandoverChannel &predecessor);
+    void publish();
+    /* wait for lease (warm standby), returns tick fired last by
+     * previous holder (none if unknown or too old) */
+    Clock::time_point standby();
+    void changed();
+    std::unique_ptr<const JobTable> snapshot() const;
+    void admin();
+    void adminWorker(const std::string &address);
+    PayloadSeq admin(const PayloadSeq &);
+    json admin(const json &);
+    void load();
+    void load(const json &adminJobs);
+    json adminJobs() const;
+    /* admin jobs as of a change, taken under tableMutex_ */
+    struct AdminState
+    {
+        uint64_t version;
+        json jobs;
+    };
+    /* caller holds tableMutex_ */
+    AdminState adminState();
+    /* written outside of tableMutex_, state older than
+     * the one already written is skipped */
+    void save(const AdminState &);
+    void realTime();
+    /* undoes realTime() inherited by a thread started by exec() */
+    void normal();
+    void wait(Clock::time_point);
 public:
-    Cron(const std::string &brokerAddr, const std::string &basePath);
+    explicit Cron(const Config &, const TimeSource &time = systemTime());
     void exec();
+    /* replay recurring jobs over [from, to) as fast as possible,
+     * print every firing or (count) number of firings per job */
+    void simulate(Clock::time_point from, Clock::time_point to, bool count);
 };
 
 } /* cron */
@@ -0,0 +1,288 @@
+#include "Dispatcher.h"
+#include "Ensure.h"
+#include "Log.h"
+
+namespace {
+
+/* per service waiting requests and ready requests, past it
+ * fires are dropped rather than piled up behind a stalled service */
+constexpr std::size_t QUEUED_MAX = 4096;
+
+} /* namespace */
+
+namespace cron {
+
+Dispatcher::Dispatcher(std::size_t threads, const LimitMap &limits)
+{
+    for(const auto &i : limits)
+    {
+        ENSURE(0 < i.second, RuntimeError);
+        services_[i.first].limit = i.second;
+    }
+
+    for(std::size_t i = 0; i < threads; ++i) threads_.emplace_back([this](){exec();});
+}
+
+Dispatcher::~Dispatcher()
+{
+    if(threads_.empty()) run();
+
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        stop_ = true;
+    }
+
+    cond_.notify_all();
+
+    for(auto &thread : threads_) thread.join();
+}
+
+void Dispatcher::enqueue(Request request)
+{
+    auto &service = services_[request.service];
+
+    if(service.limit && service.limit <= service.inFlight)
+    {
+        if(QUEUED_MAX <= service.waiting.size())
+        {
+            drop(request);
+            return;
+        }
+
+        ++deferred_;
+        service.waiting.push_back(std::move(request));
+        return;
+    }
+
+    if(QUEUED_MAX <= ready_.size())
+    {
+        drop(request);
+        return;
+    }
+
+    ++service.inFlight;
+    ready_.push_back(std::move(request));
+    cond_.notify_one();
+}
+
+void Dispatcher::drop(const Request &request)
+{
+    dropped_ += request.keys.size();
+    CRON_ERROR("dropped ", request.service, ' ', uint64_t(request.keys.size()));
+    release(request.keys);
+}
+
+void Dispatcher::release(const KeySeq &keys)
+{
+    for(const auto &id : keys)
+    {
+        const auto i = keys_.find(id);
+
+        ASSERT(keys_.end() != i);
+
+        auto &key = i->second;
+
+        if(--key.outstanding) continue;
+
+        if(key.queued)
+        {
+            key.queued = false;
+            ++key.outstanding;
+            enqueue(std::move(key.pending));
+            continue;
+        }
+
+        keys_.erase(i);
+    }
+
+    if(keys_.empty()) idle_.notify_all();
+}
+
+void Dispatcher::done(const Request &request)
+{
+    auto &service = services_[request.service];
+
+    --service.inFlight;
+
+    if(!service.waiting.empty() && (!service.limit || service.limit > service.inFlight))
+    {
+        ++service.inFlight;
+        ready_.push_back(std::move(service.waiting.front()));
+        service.waiting.pop_front();
+        cond_.notify_one();
+    }
+
+    release(request.keys);
+}
+
+void Dispatcher::send(Request &request)
+{
+    try
+    {
+        request.send();
+    }
+    catch(const std::exception &except)
+    {
+        CRON_ERROR(request.service, ' ', except.what());
+    }
+    catch(...)
+    {
+        CRON_ERROR(request.service, " unsupported exception");
+    }
+}
+
+void Dispatcher::exec()
+{
+    for(;;)
+    {
+        Request request;
+
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+
+            cond_.wait(lock, [this](){return stop_ || !ready_.empty();});
+
+            /* completions of others refill ready_, the last one drains it */
+            if(ready_.empty()) return;
+
+            request = std::move(ready_.front());
+            ready_.pop_front();
+        }
+
+        send(request);
+
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        done(request);
+    }
+}
+
+void Dispatcher::run()
+{
+    for(;;)
+    {
+        Request request;
+
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+
+            /* one released by a request of another thread is run there */
+            if(ready_.empty()) return;
+
+            request = std::move(ready_.front());
+            ready_.pop_front();
+        }
+
+        send(request);
+
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        done(request);
+    }
+}
+
+void Dispatcher::submit(
+    const std::string &service,
+    const std::string &key,
+    Overlap overlap,
+    Send send)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        const auto i = keys_.find(key);
+        const auto outstanding = keys_.end() != i && i->second.outstanding;
+
+        if(outstanding && Overlap::SkipIfRunning == overlap)
+        {
+            ++skipped_;
+            CRON_INFO("skipped ", key);
+            return;
+        }
+
+        if(outstanding && Overlap::QueueOne == overlap)
+        {
+            if(i->second.queued)
+            {
+                ++skipped_;
+                CRON_INFO("skipped ", key);
+                return;
+            }
+
+            ++deferred_;
+            i->second.queued = true;
+            i->second.pending = Request{service, {key}, std::move(send)};
+            return;
+        }
+
+        ++keys_[key].outstanding;
+        enqueue(Request{service, {key}, std::move(send)});
+    }
+
+    if(threads_.empty()) run();
+}
+
+bool Dispatcher::reserve(const std::string &key)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    auto &entry = keys_[key];
+
+    if(entry.outstanding) return false;
+
+    ++entry.outstanding;
+    return true;
+}
+
+void Dispatcher::submit(const std::string &service, KeySeq keys, Send send)
+{
+    ENSURE(!keys.empty(), RuntimeError);
+
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        enqueue(Request{service, std::move(keys), std::move(send)});
+    }
+
+    if(threads_.empty()) run();
+}
+
+void Dispatcher::cancel(const KeySeq &keys)
+{
+    if(keys.empty()) return;
+
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        release(keys);
+    }
+
+    /* queued fire of a cancelled key may have been released */
+    if(threads_.empty()) run();
+}
+
+void Dispatcher::drain()
+{
+    if(threads_.empty()) run();
+
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    idle_.wait(lock, [this](){return keys_.empty();});
+}
+
+auto Dispatcher::stats() -> Stats
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    Stats stats{skipped_, deferred_, dropped_, {}};
+
+    for(const auto &i : services_)
+    {
+        if(i.second.inFlight) stats.inFlight[i.first] = i.second.inFlight;
+    }
+
+    return stats;
+}
+
+} /* cron */
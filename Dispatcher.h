@@ -0,0 +1,114 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Job.h"
+
+namespace cron {
+
+/* sends requests on a pool of threads, or on the submitting
+ * thread if there is none
+ *
+ * A job fired while its previous request is outstanding is sent anyway,
+ * skipped or kept (one) until it completes, as its overlap policy says.
+ * Requests of a service over its in-flight limit wait (deferred) for
+ * one of the service's requests to complete. Requests past the queue
+ * limit are dropped. */
+class Dispatcher
+{
+public:
+    /* performs the request, exceptions are logged, returns once it is
+     * complete (replied or not delivered), its keys are outstanding
+     * until then */
+    using Send = std::function<void()>;
+    using LimitMap = std::map<std::string, std::size_t>;
+    using KeySeq = std::vector<std::string>;
+
+    struct Stats
+    {
+        uint64_t skipped;
+        uint64_t deferred;
+        uint64_t dropped;
+        std::map<std::string, std::size_t> inFlight;
+    };
+private:
+    struct Request
+    {
+        std::string service;
+        /* jobs sent by the request */
+        KeySeq keys;
+        Send send;
+    };
+
+    struct Key
+    {
+        /* admitted, running or waiting for service capacity */
+        std::size_t outstanding = 0;
+        /* queue-one: fired while outstanding */
+        bool queued = false;
+        Request pending;
+    };
+
+    struct Service
+    {
+        std::size_t limit = 0;
+        std::size_t inFlight = 0;
+        std::deque<Request> waiting;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    /* nothing is outstanding */
+    std::condition_variable idle_;
+    bool stop_ = false;
+    std::deque<Request> ready_;
+    std::unordered_map<std::string, Key> keys_;
+    std::map<std::string, Service> services_;
+    uint64_t skipped_ = 0;
+    uint64_t deferred_ = 0;
+    uint64_t dropped_ = 0;
+    std::vector<std::thread> threads_;
+
+    /* caller holds mutex_, keys are counted as outstanding */
+    void enqueue(Request);
+    void drop(const Request &);
+    void release(const KeySeq &);
+    void done(const Request &);
+    void send(Request &);
+    /* pool thread */
+    void exec();
+    /* ready requests on the calling thread, without pool */
+    void run();
+public:
+    /* limits: in-flight maximum per service, others are not limited */
+    Dispatcher(std::size_t threads, const LimitMap &limits);
+    /* sends everything submitted so far */
+    ~Dispatcher();
+
+    Dispatcher(const Dispatcher &) = delete;
+    Dispatcher &operator=(const Dispatcher &) = delete;
+
+    /* key identifies the job for overlap policy */
+    void submit(const std::string &service, const std::string &key, Overlap, Send);
+    /* false if previous request of key is outstanding, otherwise
+     * key is outstanding until submitted request completes */
+    bool reserve(const std::string &key);
+    /* request of reserved keys */
+    void submit(const std::string &service, KeySeq keys, Send);
+    /* reserved keys not submitted */
+    void cancel(const KeySeq &keys);
+    /* waits until every submitted request is sent or dropped */
+    void drain();
+    Stats stats();
+};
+
+} /* cron */
@@ -0,0 +1,160 @@
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Ensure.h"
+#include "FireRing.h"
+
+namespace {
+
+/* segment created concurrently gets its size and header within it */
+constexpr auto ATTACH_TIMEOUT = std::chrono::seconds{1};
+constexpr auto ATTACH_POLL = std::chrono::milliseconds{1};
+
+} /* namespace */
+
+void FireRing::map(int fd, std::size_t size, bool writable)
+{
+    const auto prot = PROT_READ | (writable ? PROT_WRITE : 0);
+
+    data_ = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if(MAP_FAILED == data_)
+    {
+        data_ = nullptr;
+        ENSURE(false, CRuntimeError);
+    }
+
+    size_ = size;
+    header_ = static_cast<Header *>(data_);
+    slots_ = reinterpret_cast<Slot *>(header_ + 1);
+}
+
+void FireRing::attach(int fd, bool writable)
+{
+    const auto deadline = std::chrono::steady_clock::now() + ATTACH_TIMEOUT;
+
+    struct ::stat s;
+
+    for(;;)
+    {
+        if(0 != ::fstat(fd, &s))
+        {
+            ::close(fd);
+            ENSURE(false, CRuntimeError);
+        }
+
+        if(sizeof(Header) <= std::size_t(s.st_size)) break;
+
+        if(std::chrono::steady_clock::now() > deadline)
+        {
+            ::close(fd);
+            ENSURE(false, RuntimeError);
+        }
+
+        std::this_thread::sleep_for(ATTACH_POLL);
+    }
+
+    map(fd, std::size_t(s.st_size), writable);
+
+    while(MAGIC != reinterpret_cast<volatile const Header *>(header_)->magic)
+    {
+        ENSURE(std::chrono::steady_clock::now() <= deadline, RuntimeError);
+        std::this_thread::sleep_for(ATTACH_POLL);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    ENSURE(VERSION == header_->version, RuntimeError);
+    ENSURE(size_ >= sizeof(Header) + sizeof(Slot) * header_->capacity, RuntimeError);
+}
+
+FireRing::FireRing(const std::string &name, uint32_t capacity):
+    name_{name}
+{
+    ENSURE(!name_.empty(), RuntimeError);
+    /* power of 2, record number maps to slot by mask */
+    ENSURE(capacity && 0 == (capacity & (capacity - 1)), RuntimeError);
+
+    const auto size = sizeof(Header) + sizeof(Slot) * capacity;
+
+    const auto fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+
+    if(-1 == fd)
+    {
+        ENSURE(EEXIST == errno, CRuntimeError);
+
+        /* predecessor's or active instance's, records go on */
+        const auto existing = ::shm_open(name_.c_str(), O_RDWR | O_CLOEXEC, 0);
+
+        ENSURE(-1 != existing, CRuntimeError);
+
+        attach(existing, true);
+
+        ENSURE(capacity == header_->capacity, RuntimeError);
+        return;
+    }
+
+    if(0 != ::ftruncate(fd, off_t(size)))
+    {
+        ::close(fd);
+        ENSURE(false, CRuntimeError);
+    }
+
+    map(fd, size, true);
+
+    /* zero filled by ftruncate, seq 0 means never written */
+    header_->version = VERSION;
+    header_->capacity = capacity;
+    header_->head.store(0);
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = MAGIC;
+}
+
+FireRing::FireRing(const std::string &name):
+    name_{name}
+{
+    ENSURE(!name_.empty(), RuntimeError);
+
+    const auto fd = ::shm_open(name_.c_str(), O_RDONLY | O_CLOEXEC, 0);
+
+    ENSURE(-1 != fd, CRuntimeError);
+
+    attach(fd, false);
+}
+
+FireRing::~FireRing()
+{
+    if(data_) ::munmap(data_, size_);
+}
+
+void FireRing::push(const FireRecord &record)
+{
+    const auto n = header_->head.fetch_add(1, std::memory_order_relaxed);
+    auto &slot = slots_[n & (header_->capacity - 1)];
+
+    slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.record, &record, sizeof(record));
+    slot.seq.store(2 * (n + 1), std::memory_order_release);
+}
+
+bool FireRing::read(uint64_t n, FireRecord &record) const
+{
+    const auto &slot = slots_[n & (header_->capacity - 1)];
+
+    if(2 * (n + 1) != slot.seq.load(std::memory_order_acquire)) return false;
+
+    std::memcpy(&record, &slot.record, sizeof(record));
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    /* overwritten while copying */
+    return 2 * (n + 1) == slot.seq.load(std::memory_order_relaxed);
+}
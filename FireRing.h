@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/* dispatch record published to shared memory observers */
+struct FireRecord
+{
+    enum Outcome : uint32_t
+    {
+        Ok = 0,
+        Failed = 1,
+        /* past its deadline, not sent */
+        Late = 2
+    };
+
+    /* ns since epoch (system clock) */
+    int64_t scheduledNs;
+    int64_t dispatchedNs;
+    int64_t completedNs;
+    uint32_t outcome;
+    uint32_t reserved;
+    /* truncated, nul terminated */
+    char service[32];
+    char job[64];
+};
+
+/* fixed size ring of FireRecord in a named shared memory segment
+ *
+ * Writers never wait for readers, each slot is guarded by a sequence
+ * (seqlock): odd while being written, 2 * (n + 1) once record n is
+ * complete. Readers detect records they were lapped on and torn reads.
+ * Slots are claimed by fetch_add, concurrent writers are fine.
+ *
+ * The segment is shared by every writer using its name (successor,
+ * standby) and kept when they exit, it is never unlinked. */
+class FireRing
+{
+    static constexpr uint64_t MAGIC = 0x676e695265726946ull; /* FireRing */
+    static constexpr uint32_t VERSION = 1;
+
+    struct Slot
+    {
+        std::atomic<uint64_t> seq;
+        FireRecord record;
+    };
+
+    struct Header
+    {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t capacity;
+        /* next record number */
+        std::atomic<uint64_t> head;
+    };
+
+    std::string name_;
+    std::size_t size_ = 0;
+    void *data_ = nullptr;
+    Header *header_ = nullptr;
+    Slot *slots_ = nullptr;
+
+    void map(int fd, std::size_t size, bool writable);
+    /* header of segment created by another process may not be
+     * written yet, size is checked against its capacity */
+    void attach(int fd, bool writable);
+public:
+    /* create segment or attach to existing one of the same capacity,
+     * capacity is power of 2 */
+    FireRing(const std::string &name, uint32_t capacity);
+    /* attach existing segment read only */
+    explicit FireRing(const std::string &name);
+    ~FireRing();
+
+    FireRing(const FireRing &) = delete;
+    FireRing &operator=(const FireRing &) = delete;
+
+    uint32_t capacity() const {return header_->capacity;}
+    uint64_t head() const {return header_->head.load(std::memory_order_acquire);}
+
+    void push(const FireRecord &);
+    /* false if record n is not complete or was overwritten */
+    bool read(uint64_t n, FireRecord &) const;
+};
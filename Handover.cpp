@@ -0,0 +1,226 @@
+#include <cerrno>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Ensure.h"
+#include "Handover.h"
+
+namespace {
+
+/* handover state is small, anything bigger is garbage */
+constexpr uint32_t MESSAGE_MAX = 64 * 1024 * 1024;
+
+::sockaddr_un address(const std::string &path)
+{
+    ::sockaddr_un addr;
+
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    ENSURE(!path.empty(), RuntimeError);
+    ENSURE(sizeof(addr.sun_path) > path.size(), RuntimeError);
+
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    return addr;
+}
+
+void write(int fd, const char *data, std::size_t size)
+{
+    while(size)
+    {
+        const auto r = ::send(fd, data, size, MSG_NOSIGNAL);
+
+        if(-1 == r && EINTR == errno) continue;
+        ENSURE(0 < r, CRuntimeError);
+
+        data += r;
+        size -= std::size_t(r);
+    }
+}
+
+void read(int fd, char *data, std::size_t size)
+{
+    while(size)
+    {
+        const auto r = ::recv(fd, data, size, 0);
+
+        if(-1 == r && EINTR == errno) continue;
+        ENSURE(-1 != r, CRuntimeError);
+        /* peer closed */
+        ENSURE(0 != r, RuntimeError);
+
+        data += r;
+        size -= std::size_t(r);
+    }
+}
+
+} /* namespace */
+
+namespace cron {
+
+HandoverChannel::HandoverChannel(int fd): fd_{fd}
+{
+    ENSURE(-1 != fd_, RuntimeError);
+}
+
+HandoverChannel::~HandoverChannel()
+{
+    ::close(fd_);
+}
+
+std::unique_ptr<HandoverChannel> HandoverChannel::connect(const std::string &path)
+{
+    const auto addr = address(path);
+    const auto fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    ENSURE(-1 != fd, CRuntimeError);
+
+    if(0 != ::connect(fd, reinterpret_cast<const ::sockaddr *>(&addr), sizeof(addr)))
+    {
+        const auto error = errno;
+
+        ::close(fd);
+        errno = error;
+
+        /* anything but no predecessor is an error */
+        ENSURE(ENOENT == error || ECONNREFUSED == error, CRuntimeError);
+        return nullptr;
+    }
+
+    return std::unique_ptr<HandoverChannel>{new HandoverChannel{fd}};
+}
+
+void HandoverChannel::send(const json &message, int fd)
+{
+    const auto data = json::to_cbor(message);
+
+    ENSURE(MESSAGE_MAX >= data.size(), RuntimeError);
+
+    /* length prefix carries the descriptor if any */
+    uint32_t size = uint32_t(data.size());
+    ::iovec iov{&size, sizeof(size)};
+    ::msghdr msg;
+    char control[CMSG_SPACE(sizeof(int))];
+
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    if(-1 != fd)
+    {
+        std::memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        auto *cmsg = CMSG_FIRSTHDR(&msg);
+
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+
+    ssize_t r;
+
+    while(-1 == (r = ::sendmsg(fd_, &msg, MSG_NOSIGNAL)) && EINTR == errno);
+
+    ENSURE(-1 != r, CRuntimeError);
+    ENSURE(sizeof(size) == std::size_t(r), RuntimeError);
+
+    write(fd_, reinterpret_cast<const char *>(data.data()), data.size());
+}
+
+json HandoverChannel::receive(int *fd)
+{
+    uint32_t size = 0;
+    ::iovec iov{&size, sizeof(size)};
+    ::msghdr msg;
+    char control[CMSG_SPACE(sizeof(int))];
+
+    std::memset(&msg, 0, sizeof(msg));
+    std::memset(control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t r;
+
+    while(-1 == (r = ::recvmsg(fd_, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC)) && EINTR == errno);
+
+    ENSURE(-1 != r, CRuntimeError);
+    ENSURE(sizeof(size) == std::size_t(r), RuntimeError);
+
+    int received = -1;
+
+    for(auto *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if(SOL_SOCKET != cmsg->cmsg_level || SCM_RIGHTS != cmsg->cmsg_type) continue;
+
+        std::memcpy(&received, CMSG_DATA(cmsg), sizeof(int));
+    }
+
+    /* nobody takes unexpected descriptor */
+    if(!fd && -1 != received) ::close(received);
+    if(fd) *fd = received;
+
+    ENSURE(MESSAGE_MAX >= size, RuntimeError);
+
+    std::vector<uint8_t> data(size);
+
+    read(fd_, reinterpret_cast<char *>(data.data()), data.size());
+    return json::from_cbor(data);
+}
+
+HandoverListener::HandoverListener(const std::string &path)
+{
+    const auto addr = address(path);
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    ENSURE(-1 != fd_, CRuntimeError);
+
+    /* left over by previous process */
+    ::unlink(path.c_str());
+
+    if(
+        0 != ::bind(fd_, reinterpret_cast<const ::sockaddr *>(&addr), sizeof(addr))
+        || 0 != ::listen(fd_, 1))
+    {
+        const auto error = errno;
+
+        ::close(fd_);
+        errno = error;
+        ENSURE(false, CRuntimeError);
+    }
+}
+
+HandoverListener::~HandoverListener()
+{
+    /* socket file is not removed, successor may be bound to it already */
+    ::close(fd_);
+}
+
+std::unique_ptr<HandoverChannel> HandoverListener::accept(std::chrono::milliseconds timeout)
+{
+    ::pollfd events{fd_, short(POLLIN), short(0)};
+    const auto r = ::poll(&events, 1, int(timeout.count()));
+
+    if(-1 == r && EINTR == errno) return nullptr;
+
+    ENSURE(-1 != r, CRuntimeError);
+
+    if(0 == r) return nullptr;
+
+    const auto fd = ::accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+
+    ENSURE(-1 != fd, CRuntimeError);
+
+    return std::unique_ptr<HandoverChannel>{new HandoverChannel{fd}};
+}
+
+} /* cron */
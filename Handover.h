@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "json.h"
+
+namespace cron {
+
+/* connected unix socket end, messages are cbor encoded json,
+ * a descriptor may travel with a message (SCM_RIGHTS) */
+class HandoverChannel
+{
+    int fd_;
+public:
+    explicit HandoverChannel(int fd);
+    ~HandoverChannel();
+
+    HandoverChannel(const HandoverChannel &) = delete;
+    HandoverChannel &operator=(const HandoverChannel &) = delete;
+
+    /* null if nobody listens at path */
+    static std::unique_ptr<HandoverChannel> connect(const std::string &path);
+
+    void send(const json &message, int fd = -1);
+    /* received descriptor (or -1) is stored to fd if not null */
+    json receive(int *fd = nullptr);
+};
+
+/* listening unix socket, stale socket file at path is replaced */
+class HandoverListener
+{
+    int fd_;
+public:
+    explicit HandoverListener(const std::string &path);
+    ~HandoverListener();
+
+    HandoverListener(const HandoverListener &) = delete;
+    HandoverListener &operator=(const HandoverListener &) = delete;
+
+    /* null on timeout */
+    std::unique_ptr<HandoverChannel> accept(std::chrono::milliseconds timeout);
+};
+
+} /* cron */
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/* log2 histogram of microsecond latencies, any number of writers,
+ * bucket 0 counts < 1us, bucket i counts [2^(i-1), 2^i) us */
+class Histogram
+{
+public:
+    static constexpr int BUCKETS = 32;
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_;
+    std::atomic<uint64_t> max_{0};
+public:
+    Histogram()
+    {
+        for(auto &i : buckets_) i = 0;
+    }
+
+    void add(std::chrono::microseconds value)
+    {
+        const auto us = uint64_t(std::max(value.count(), decltype(value.count())(0)));
+        const auto bucket = us ? std::min(64 - __builtin_clzll(us), BUCKETS - 1) : 0;
+
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+        auto max = max_.load(std::memory_order_relaxed);
+
+        while(max < us && !max_.compare_exchange_weak(max, us, std::memory_order_relaxed));
+    }
+
+    uint64_t count(int bucket) const {return buckets_[bucket].load(std::memory_order_relaxed);}
+    uint64_t max() const {return max_.load(std::memory_order_relaxed);}
+
+    /* exclusive upper bound of bucket in us */
+    static uint64_t bound(int bucket) {return uint64_t(1) << bucket;}
+
+    friend
+    std::ostream &operator<<(std::ostream &os, const Histogram &histogram)
+    {
+        for(int i = 0; i < BUCKETS; ++i)
+        {
+            const auto n = histogram.count(i);
+
+            if(n) os << '<' << bound(i) << "us:" << n << ' ';
+        }
+
+        os << "max:" << histogram.max() << "us";
+        return os;
+    }
+};
@@ -0,0 +1,238 @@
+#include "Ensure.h"
+#include "Job.h"
+#include "Log.h"
+#include "Trace.h"
+#include "fs.h"
+
+namespace {
+
+constexpr auto SERVICE = "service";
+constexpr auto PAYLOAD = "payload";
+constexpr auto PRIORITY = "priority";
+constexpr auto DEADLINE_MS = "deadline_ms";
+constexpr auto OVERLAP = "overlap";
+constexpr auto OVERLAP_ALLOW = "allow";
+constexpr auto OVERLAP_SKIP_IF_RUNNING = "skip_if_running";
+constexpr auto OVERLAP_QUEUE_ONE = "queue_one";
+
+constexpr auto JSON_EXT = ".json";
+constexpr auto CBOR_EXT = ".cbor";
+constexpr auto MSGPACK_EXT = ".msgpack";
+
+/* file job id is path#index */
+constexpr auto ID_SEPARATOR = '#';
+
+using cron::json;
+
+json::input_format_t inputFormat(const std::string &path)
+{
+    if(isExtention(path, CBOR_EXT)) return json::input_format_t::cbor;
+    if(isExtention(path, MSGPACK_EXT)) return json::input_format_t::msgpack;
+    return json::input_format_t::json;
+}
+
+/* builds one top level array element at a time and turns it into a Job,
+ * elements are dropped as soon as they are parsed */
+class JobSax: public json::json_sax_t
+{
+    const std::string &path_;
+    cron::JobSeq &seq_;
+    /* inside top level array */
+    bool top_ = false;
+    json job_;
+    /* open containers of job_ */
+    std::vector<json *> stack_;
+    std::string key_;
+
+    template <typename T>
+    bool value(T &&v)
+    {
+        ENSURE(top_, RuntimeError);
+
+        if(stack_.empty())
+        {
+            job_ = std::forward<T>(v);
+            complete();
+            return true;
+        }
+
+        auto *parent = stack_.back();
+
+        if(parent->is_array()) parent->push_back(std::forward<T>(v));
+        else (*parent)[key_] = std::forward<T>(v);
+        return true;
+    }
+
+    bool open(json container)
+    {
+        if(!top_ && stack_.empty())
+        {
+            /* job file has to be an array */
+            ENSURE(container.is_array(), RuntimeError);
+            top_ = true;
+            return true;
+        }
+
+        if(stack_.empty())
+        {
+            job_ = std::move(container);
+            stack_.push_back(&job_);
+            return true;
+        }
+
+        auto *parent = stack_.back();
+
+        if(parent->is_array())
+        {
+            parent->push_back(std::move(container));
+            stack_.push_back(&parent->back());
+        }
+        else
+        {
+            stack_.push_back(&((*parent)[key_] = std::move(container)));
+        }
+        return true;
+    }
+
+    bool close()
+    {
+        if(stack_.empty())
+        {
+            /* end of top level array */
+            top_ = false;
+            return true;
+        }
+
+        stack_.pop_back();
+        if(stack_.empty()) complete();
+        return true;
+    }
+
+    void complete()
+    {
+        auto id = path_ + ID_SEPARATOR + std::to_string(seq_.size());
+
+        seq_.push_back(cron::parseJob(path_, std::move(id), job_));
+        CRON_INFO("job ", seq_.back().id(), ' ', seq_.back().service());
+        job_ = json{};
+    }
+public:
+    JobSax(const std::string &path, cron::JobSeq &seq): path_{path}, seq_{seq}
+    {}
+
+    bool null() override {return value(nullptr);}
+    bool boolean(bool v) override {return value(v);}
+    bool number_integer(number_integer_t v) override {return value(v);}
+    bool number_unsigned(number_unsigned_t v) override {return value(v);}
+    bool number_float(number_float_t v, const string_t &) override {return value(v);}
+    bool string(string_t &v) override {return value(std::move(v));}
+    bool binary(binary_t &v) override {return value(json::binary(std::move(v)));}
+    bool start_object(std::size_t) override {return open(json::object());}
+    bool key(string_t &v) override {key_ = std::move(v); return true;}
+    bool end_object() override {return close();}
+    bool start_array(std::size_t) override {return open(json::array());}
+    bool end_array() override {return close();}
+
+    bool parse_error(
+        std::size_t,
+        const std::string &,
+        const nlohmann::detail::exception &except) override
+    {
+        TRACE(TraceLevel::Error, path_, ' ', except.what());
+        return false;
+    }
+};
+
+} /* namespace */
+
+namespace cron {
+
+Job parseJob(std::string path, std::string id, const json &input)
+{
+    const auto atValue = parseAtValue(input);
+
+    ENSURE(input.count(SERVICE), RuntimeError);
+    ENSURE(input[SERVICE].is_string(), RuntimeError);
+
+    const auto service = input[SERVICE].get<std::string>();
+
+    ENSURE(input.count(PAYLOAD), RuntimeError);
+    ENSURE(input[PAYLOAD].is_array(), RuntimeError);
+
+    int priority = 0;
+
+    if(input.count(PRIORITY))
+    {
+        ENSURE(input[PRIORITY].is_number_integer(), RuntimeError);
+        priority = input[PRIORITY].get<int>();
+    }
+
+    int64_t deadline = 0;
+
+    if(input.count(DEADLINE_MS))
+    {
+        ENSURE(input[DEADLINE_MS].is_number_integer(), RuntimeError);
+        deadline = input[DEADLINE_MS].get<int64_t>();
+        ENSURE(0 < deadline, RuntimeError);
+    }
+
+    auto overlap = Overlap::Allow;
+
+    if(input.count(OVERLAP))
+    {
+        ENSURE(input[OVERLAP].is_string(), RuntimeError);
+
+        const auto value = input[OVERLAP].get<std::string>();
+
+        if(OVERLAP_SKIP_IF_RUNNING == value) overlap = Overlap::SkipIfRunning;
+        else if(OVERLAP_QUEUE_ONE == value) overlap = Overlap::QueueOne;
+        else ENSURE(OVERLAP_ALLOW == value, RuntimeError);
+    }
+
+    return
+    {
+        std::move(path),
+        std::move(id),
+        std::move(atValue),
+        std::move(service),
+        input[PAYLOAD],
+        priority,
+        std::chrono::milliseconds{deadline},
+        overlap
+    };
+}
+
+std::ostream &operator<<(std::ostream &os, const Job &job)
+{
+    os
+        << job.atValue_
+        << ' ' << job.id_
+        << ' ' << job.service_
+        << ' ' << job.payload_;
+    return os;
+}
+
+bool isJobFile(const std::string &path)
+{
+    return
+        isExtention(path, JSON_EXT)
+        || isExtention(path, CBOR_EXT)
+        || isExtention(path, MSGPACK_EXT);
+}
+
+JobSeq loadJobFile(const std::string &path)
+{
+    const MappedFile file{path};
+
+    JobSeq seq;
+    JobSax sax{path, seq};
+
+    const auto parsed =
+        json::sax_parse(file.begin(), file.end(), &sax, inputFormat(path));
+
+    ENSURE(parsed, RuntimeError);
+
+    return seq;
+}
+
+} /* cron */
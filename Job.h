@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "AtValue.h"
+#include "PayloadTemplate.h"
+#include "json.h"
+
+namespace cron {
+
+/* what a fire does while the job's previous request is outstanding */
+enum class Overlap
+{
+    Allow,
+    SkipIfRunning,
+    /* keep one fire, sent once the outstanding request completes */
+    QueueOne
+};
+
+class Job
+{
+protected:
+    /* canonical filename path - the job comes from,
+     * will be used to remove job in case file is deleted/moved */
+    std::string path_;
+    /* path#index for file jobs, admin id for admin jobs */
+    std::string id_;
+    AtValue atValue_;
+    std::string service_;
+    PayloadTemplate payload_;
+    /* due jobs of a tick are dispatched highest priority first */
+    int priority_;
+    /* dropped instead of sent this late past scheduled time, 0 - never */
+    std::chrono::milliseconds deadline_;
+    Overlap overlap_;
+
+    friend
+    Job parseJob(std::string path, std::string id, const json &);
+public:
+    Job(
+        std::string path,
+        std::string id,
+        AtValue atValue,
+        std::string service,
+        const json &payload,
+        int priority = 0,
+        std::chrono::milliseconds deadline = std::chrono::milliseconds{0},
+        Overlap overlap = Overlap::Allow):
+        path_{std::move(path)},
+        id_{std::move(id)},
+        atValue_{std::move(atValue)},
+        service_{std::move(service)},
+        payload_{payload, id_},
+        priority_{priority},
+        deadline_{deadline},
+        overlap_{overlap}
+    {}
+
+    bool expired(const std::tm &tm) const {return atValue_.expired(tm);}
+    const AtValue &atValue() const {return atValue_;}
+    const std::string &id() const {return id_;}
+    const std::string &service() const {return service_;}
+    const PayloadTemplate &payload() const {return payload_;}
+    int priority() const {return priority_;}
+    std::chrono::milliseconds deadline() const {return deadline_;}
+    Overlap overlap() const {return overlap_;}
+
+    friend
+    std::ostream &operator<< (std::ostream &, const Job &);
+};
+
+using JobSeq = std::vector<Job>;
+
+Job parseJob(std::string path, std::string id, const json &);
+
+/* job files are json arrays of jobs, cbor/msgpack encoded
+ * files (same layout) are accepted for generated job sets */
+bool isJobFile(const std::string &path);
+/* stream jobs out of path without building the document,
+ * memory peak is bounded by the largest single job */
+JobSeq loadJobFile(const std::string &path);
+
+} /* cron */
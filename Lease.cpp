@@ -0,0 +1,190 @@
+#include <cerrno>
+#include <random>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include "Ensure.h"
+#include "Lease.h"
+#include "Trace.h"
+
+namespace {
+
+int64_t epochMs()
+{
+    using namespace std::chrono;
+
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+uint64_t token()
+{
+    std::random_device device;
+    uint64_t token = 0;
+
+    /* 0 is nobody */
+    while(!token) token = (uint64_t(device()) << 32 | device()) ^ uint64_t(::getpid());
+
+    return token;
+}
+
+/* record lock, blocks only while another instance updates the record */
+class RecordLock
+{
+    int fd_;
+
+    void set(short type)
+    {
+        struct flock lock{};
+
+        lock.l_type = type;
+        lock.l_whence = SEEK_SET;
+
+        while(-1 == ::fcntl(fd_, F_SETLKW, &lock)) ENSURE(EINTR == errno, CRuntimeError);
+    }
+public:
+    explicit RecordLock(int fd):
+        fd_{fd}
+    {
+        set(F_WRLCK);
+    }
+
+    ~RecordLock()
+    {
+        struct flock lock{};
+
+        lock.l_type = F_UNLCK;
+        lock.l_whence = SEEK_SET;
+        ::fcntl(fd_, F_SETLK, &lock);
+    }
+
+    RecordLock(const RecordLock &) = delete;
+    RecordLock &operator=(const RecordLock &) = delete;
+};
+
+} /* namespace */
+
+namespace cron {
+
+Lease::Lease(const std::string &path, std::chrono::milliseconds stale):
+    fd_{::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)},
+    stale_{stale},
+    token_{token()}
+{
+    ENSURE(-1 != fd_, CRuntimeError);
+}
+
+Lease::~Lease()
+{
+    /* releases the locks */
+    ::close(fd_);
+}
+
+auto Lease::read() const -> Record
+{
+    Record record{};
+    const auto r = ::pread(fd_, &record, sizeof(record), 0);
+
+    ENSURE(-1 != r, CRuntimeError);
+
+    /* empty lease file or one of an older version (tick only) */
+    if(sizeof(record) != std::size_t(r))
+    {
+        const auto tick = sizeof(record.tick) <= std::size_t(r) ? record.tick : 0;
+
+        record = Record{};
+        record.tick = tick;
+    }
+
+    return record;
+}
+
+void Lease::write(const Record &record)
+{
+    const auto r = ::pwrite(fd_, &record, sizeof(record), 0);
+
+    ENSURE(sizeof(record) == std::size_t(r), CRuntimeError);
+}
+
+bool Lease::lock()
+{
+    if(locked_) return false;
+
+    if(0 == ::flock(fd_, LOCK_EX | LOCK_NB))
+    {
+        locked_ = true;
+        return true;
+    }
+
+    ENSURE(EWOULDBLOCK == errno || EINTR == errno, CRuntimeError);
+    return false;
+}
+
+bool Lease::acquire()
+{
+    if(held_) return true;
+
+    RecordLock recordLock{fd_};
+
+    /* a holder holding the file lock has exited if it is acquired now */
+    const auto released = lock();
+    auto record = read();
+    const auto now = epochMs();
+
+    if(record.owner && token_ != record.owner)
+    {
+        if(record.locked && released)
+        {
+            TRACE(TraceLevel::Info, "lease holder exited");
+        }
+        else if(now - record.heartbeat > stale_.count())
+        {
+            TRACE(TraceLevel::Error, "lease holder stale for ", now - record.heartbeat, " ms, taking over");
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    record.owner = token_;
+    record.locked = locked_;
+    record.heartbeat = now;
+    write(record);
+    held_ = true;
+    return true;
+}
+
+int64_t Lease::tick() const
+{
+    return read().tick;
+}
+
+bool Lease::renew(int64_t tick)
+{
+    ENSURE(held_, RuntimeError);
+
+    RecordLock recordLock{fd_};
+
+    auto record = read();
+
+    if(token_ != record.owner)
+    {
+        TRACE(TraceLevel::Error, "lease taken over");
+        held_ = false;
+        return false;
+    }
+
+    /* a holder which took a stale lease over gets the file lock
+     * once the previous holder exits */
+    lock();
+
+    record.tick = tick;
+    record.heartbeat = epochMs();
+    record.locked = locked_;
+    write(record);
+    return true;
+}
+
+} /* cron */
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace cron {
+
+/* exclusive lease on a file
+ *
+ * The lease file records its holder (owner token), the holder's last
+ * heartbeat and the tick (epoch seconds) it is about to fire, next holder
+ * resumes after it. The holder renews on every tick, a renewal fails once
+ * another instance took the lease over.
+ *
+ * The lease is free when nobody recorded, when the holder's heartbeat is
+ * older than stale (holder stuck) or when the holder's file lock (flock) is
+ * released (holder exited or died, taken over at once). Record updates are
+ * serialized by a record lock (fcntl) held only while updating. */
+class Lease
+{
+    struct Record
+    {
+        int64_t tick;
+        /* epoch ms */
+        int64_t heartbeat;
+        uint64_t owner;
+        /* owner holds the file lock */
+        uint64_t locked;
+    };
+
+    int fd_;
+    std::chrono::milliseconds stale_;
+    uint64_t token_;
+    /* file lock, kept until exit once acquired */
+    bool locked_ = false;
+    bool held_ = false;
+
+    Record read() const;
+    void write(const Record &);
+    /* file lock, true if acquired by this call */
+    bool lock();
+public:
+    Lease(const std::string &path, std::chrono::milliseconds stale);
+    ~Lease();
+
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+
+    /* does not block, true if held */
+    bool acquire();
+    bool held() const {return held_;}
+
+    /* last tick recorded by any holder, 0 if none */
+    int64_t tick() const;
+    /* records tick and heartbeat, false if lease was taken over */
+    bool renew(int64_t tick);
+};
+
+} /* cron */
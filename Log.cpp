@@ -0,0 +1,128 @@
+#include <iomanip>
+#include <sstream>
+
+#include "Log.h"
+
+namespace {
+
+/* background thread poll period when buffer is drained */
+constexpr auto POLL = std::chrono::milliseconds{1};
+
+} /* namespace */
+
+AsyncLog &AsyncLog::instance()
+{
+    static AsyncLog log;
+
+    return log;
+}
+
+AsyncLog::AsyncLog():
+    entries_(CAPACITY)
+{
+    for(std::size_t i = 0; i < CAPACITY; ++i) entries_[i].seq.store(i);
+
+    thread_ = std::thread{[this](){exec();}};
+}
+
+AsyncLog::~AsyncLog()
+{
+    stop_ = true;
+    thread_.join();
+}
+
+AsyncLog::Entry *AsyncLog::claim(uint64_t &pos)
+{
+    pos = head_.load(std::memory_order_relaxed);
+
+    for(;;)
+    {
+        auto &entry = entries_[pos & (CAPACITY - 1)];
+        const auto diff =
+            int64_t(entry.seq.load(std::memory_order_acquire)) - int64_t(pos);
+
+        if(0 == diff)
+        {
+            if(head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                return &entry;
+            }
+        }
+        else if(0 > diff)
+        {
+            /* full, consumer is a lap behind */
+            return nullptr;
+        }
+        else
+        {
+            pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncLog::commit(Entry &entry, uint64_t pos)
+{
+    entry.seq.store(pos + 1, std::memory_order_release);
+}
+
+bool AsyncLog::pop()
+{
+    auto &entry = entries_[tail_ & (CAPACITY - 1)];
+
+    if(tail_ + 1 != entry.seq.load(std::memory_order_acquire)) return false;
+
+    std::ostringstream os;
+
+    os
+        << '@' << entry.ns / 1000000000
+        << '.' << std::setw(6) << std::setfill('0') << entry.ns / 1000 % 1000000
+        << std::setfill(' ') << ' ';
+
+    for(std::size_t i = 0; i < entry.count; ++i)
+    {
+        const auto &arg = entry.args[i];
+
+        switch(arg.type)
+        {
+            case Arg::Int: os << arg.i; break;
+            case Arg::UInt: os << arg.u; break;
+            case Arg::Double: os << arg.d; break;
+            case Arg::Char: os << arg.c; break;
+            case Arg::Text: os.write(entry.text + arg.offset, arg.size); break;
+        }
+    }
+
+    const auto level = entry.level;
+
+    /* entry is free for producers from here */
+    entry.seq.store(tail_ + CAPACITY, std::memory_order_release);
+    ++tail_;
+
+    LOG(level, os.str());
+    return true;
+}
+
+void AsyncLog::exec()
+{
+    uint64_t reported = 0;
+
+    for(;;)
+    {
+        /* stop is checked before draining, nothing pushed earlier is lost */
+        const bool stop = stop_;
+
+        while(pop());
+
+        const auto dropped = dropped_.load(std::memory_order_relaxed);
+
+        if(dropped != reported)
+        {
+            LOG(TraceLevel::Error, dropped - reported, " log records dropped");
+            reported = dropped;
+        }
+
+        if(stop) break;
+
+        std::this_thread::sleep_for(POLL);
+    }
+}
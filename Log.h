@@ -0,0 +1,206 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Trace.h"
+
+/* compile time minimum level of CRON_DEBUG/CRON_INFO/CRON_ERROR,
+ * calls below it are removed by preprocessor, arguments included */
+#define CRON_LOG_DEBUG 0
+#define CRON_LOG_INFO 1
+#define CRON_LOG_ERROR 2
+
+#ifndef CRON_LOG_LEVEL
+#define CRON_LOG_LEVEL CRON_LOG_INFO
+#endif
+
+#if CRON_LOG_LEVEL <= CRON_LOG_DEBUG
+#define CRON_DEBUG(...) AsyncLog::instance().push(TraceLevel::Debug, __VA_ARGS__)
+#else
+#define CRON_DEBUG(...) ((void)0)
+#endif
+
+#if CRON_LOG_LEVEL <= CRON_LOG_INFO
+#define CRON_INFO(...) AsyncLog::instance().push(TraceLevel::Info, __VA_ARGS__)
+#else
+#define CRON_INFO(...) ((void)0)
+#endif
+
+#if CRON_LOG_LEVEL <= CRON_LOG_ERROR
+#define CRON_ERROR(...) AsyncLog::instance().push(TraceLevel::Error, __VA_ARGS__)
+#else
+#define CRON_ERROR(...) ((void)0)
+#endif
+
+/* log for hot paths
+ *
+ * push() only copies arguments (numbers, chars, strings truncated
+ * to TEXT bytes in total) into a bounded lock-free MPSC buffer,
+ * background thread formats records and writes them through LOG.
+ * Records are dropped (and counted) if the buffer is full,
+ * callers never wait. */
+class AsyncLog
+{
+    static constexpr std::size_t CAPACITY = 1 << 14;
+    static constexpr std::size_t ARGS = 8;
+    static constexpr std::size_t TEXT = 192;
+
+    struct Arg
+    {
+        enum Type : uint8_t
+        {
+            Int,
+            UInt,
+            Double,
+            Char,
+            Text
+        };
+
+        Type type;
+        /* Text: text range of the entry */
+        uint16_t offset;
+        uint16_t size;
+
+        union
+        {
+            int64_t i;
+            uint64_t u;
+            double d;
+            char c;
+        };
+    };
+
+    struct Entry
+    {
+        /* Vyukov bounded queue cell sequence */
+        std::atomic<uint64_t> seq;
+        TraceLevel level;
+        uint8_t count;
+        uint16_t used;
+        /* capture time, ns since epoch (system clock) */
+        int64_t ns;
+        Arg args[ARGS];
+        char text[TEXT];
+    };
+
+    std::vector<Entry> entries_;
+    std::atomic<uint64_t> head_{0};
+    /* consumer only */
+    uint64_t tail_ = 0;
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+
+    AsyncLog();
+
+    Entry *claim(uint64_t &pos);
+    void commit(Entry &, uint64_t pos);
+    /* false if empty */
+    bool pop();
+    void exec();
+
+    static void encodeText(Entry &entry, const char *text, std::size_t size)
+    {
+        auto &arg = entry.args[entry.count++];
+
+        size = std::min(size, TEXT - entry.used);
+        arg.type = Arg::Text;
+        arg.offset = entry.used;
+        arg.size = uint16_t(size);
+        std::memcpy(entry.text + entry.used, text, size);
+        entry.used = uint16_t(entry.used + size);
+    }
+
+    static void encode(Entry &entry, const std::string &value)
+    {
+        encodeText(entry, value.data(), value.size());
+    }
+
+    static void encode(Entry &entry, const char *value)
+    {
+        encodeText(entry, value, std::strlen(value));
+    }
+
+    static void encode(Entry &entry, char value)
+    {
+        auto &arg = entry.args[entry.count++];
+
+        arg.type = Arg::Char;
+        arg.c = value;
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value>::type
+    encode(Entry &entry, T value)
+    {
+        auto &arg = entry.args[entry.count++];
+
+        if(std::is_signed<T>::value)
+        {
+            arg.type = Arg::Int;
+            arg.i = int64_t(value);
+        }
+        else
+        {
+            arg.type = Arg::UInt;
+            arg.u = uint64_t(value);
+        }
+    }
+
+    static void encode(Entry &entry, double value)
+    {
+        auto &arg = entry.args[entry.count++];
+
+        arg.type = Arg::Double;
+        arg.d = value;
+    }
+
+    static void encode(Entry &) {}
+
+    template <typename T, typename... A>
+    static void encode(Entry &entry, const T &value, const A &...args)
+    {
+        encode(entry, value);
+        encode(entry, args...);
+    }
+public:
+    static AsyncLog &instance();
+
+    ~AsyncLog();
+
+    AsyncLog(const AsyncLog &) = delete;
+    AsyncLog &operator=(const AsyncLog &) = delete;
+
+    uint64_t dropped() const {return dropped_.load(std::memory_order_relaxed);}
+
+    template <typename... A>
+    void push(TraceLevel level, const A &...args)
+    {
+        static_assert(ARGS >= sizeof...(A), "too many log arguments");
+
+        uint64_t pos;
+        auto *entry = claim(pos);
+
+        if(!entry)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        entry->level = level;
+        entry->count = 0;
+        entry->used = 0;
+        entry->ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        encode(*entry, args...);
+        commit(*entry, pos);
+    }
+};
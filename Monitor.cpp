@@ -65,6 +65,20 @@ Monitor::Monitor()
     ENSURE(-1 != fd_, CRuntimeError);
 }
 
+Monitor::Monitor(int fd): fd_{fd}
+{
+    ENSURE(-1 != fd_, RuntimeError);
+}
+
+int Monitor::release()
+{
+    const auto fd = fd_;
+
+    fd_ = -1;
+    map_.clear();
+    return fd;
+}
+
 Monitor::~Monitor()
 {
     if(-1 != fd_)
@@ -122,7 +136,8 @@ auto Monitor::poll(mSecs timeout) -> EventSeq
         {
             //TRACE(TraceLevel::Debug, "event");
 
-            char buf[sizeof(::inotify_event) + NAME_MAX + 1];
+            /* room for several events, read() returns whole ones */
+            alignas(::inotify_event) char buf[16 * (sizeof(::inotify_event) + NAME_MAX + 1)];
             auto r = ::read(fd_, buf, sizeof(buf));
 
             /* fd_ is non-blocking (no data to read) */
@@ -134,15 +149,20 @@ auto Monitor::poll(mSecs timeout) -> EventSeq
             /* check if at least 1 inotify_event struct was read */
             ENSURE(int(sizeof(::inotify_event)) <= r, RuntimeError);
 
-            const auto *event = reinterpret_cast<const ::inotify_event *>(buf);
-
-            if(map_.count(event->wd))
+            for(const char *i = buf; i < buf + r;)
             {
+                const auto *event = reinterpret_cast<const ::inotify_event *>(i);
+
+                i += sizeof(::inotify_event) + event->len;
+
+                if(!map_.count(event->wd)) continue;
+
                 eventSeq.emplace_back(
                     event->wd,
                     map_[event->wd].path(),
                     event->mask,
-                    std::string(event->name));
+                    /* no name for events of watched path itself */
+                    event->len ? std::string(event->name) : std::string{});
             }
         }
     }
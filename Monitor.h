@@ -94,7 +94,16 @@ private:
     Map map_;
 public:
     Monitor();
+    /* adopt inotify descriptor (handed over by another process),
+     * add() of a watched path gets its existing watch back */
+    explicit Monitor(int fd);
     ~Monitor();
+
+    Monitor(const Monitor &) = delete;
+    Monitor &operator=(const Monitor &) = delete;
+
+    /* give up inotify descriptor, queued events are kept */
+    int release();
     void add(std::string path, EventType);
     EventSeq poll(mSecs timeout);
 };
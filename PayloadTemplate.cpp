@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cstring>
+
+#include "PayloadTemplate.h"
+
+namespace {
+
+constexpr auto PLACEHOLDER_BEGIN = "${";
+constexpr auto PLACEHOLDER_END = '}';
+constexpr auto SCHEDULED_TS = "scheduled_ts";
+constexpr auto SCHEDULED_MS = "scheduled_ms";
+constexpr auto SEQ = "seq";
+constexpr auto JOB_ID = "job_id";
+
+/* quote at pos is a json string delimiter, not escaped \" */
+bool isDelimiter(const std::string &text, std::size_t pos)
+{
+    if(text.size() <= pos || '"' != text[pos]) return false;
+
+    std::size_t backslashes = 0;
+
+    while(pos > backslashes && '\\' == text[pos - backslashes - 1]) ++backslashes;
+    return 0 == backslashes % 2;
+}
+
+void append(std::string &frame, uint64_t value)
+{
+    char buf[20];
+    auto *end = buf + sizeof(buf);
+    auto *begin = end;
+
+    do
+    {
+        *--begin = char('0' + value % 10);
+        value /= 10;
+    }
+    while(value);
+
+    frame.append(begin, end);
+}
+
+} /* namespace */
+
+namespace cron {
+
+PayloadTemplate::PayloadTemplate(const json &payload, const std::string &jobId)
+{
+    const auto input = payload.dump();
+    const auto quotedId = json(jobId).dump();
+    const auto beginSize = std::strlen(PLACEHOLDER_BEGIN);
+
+    text_.reserve(input.size());
+
+    std::size_t pos = 0;
+
+    for(;;)
+    {
+        const auto begin = input.find(PLACEHOLDER_BEGIN, pos);
+
+        if(std::string::npos == begin) break;
+
+        const auto end = input.find(PLACEHOLDER_END, begin + beginSize);
+
+        if(std::string::npos == end) break;
+
+        const auto name = input.substr(begin + beginSize, end - begin - beginSize);
+        /* placeholder is the whole json string, not an object key
+         * (keys must stay strings) */
+        const auto whole =
+            0 < begin
+            && isDelimiter(input, begin - 1)
+            && isDelimiter(input, end + 1)
+            && ':' != input[std::min(end + 2, input.size() - 1)];
+
+        Field field;
+
+        if(SCHEDULED_TS == name) field = Field::ScheduledTs;
+        else if(SCHEDULED_MS == name) field = Field::ScheduledMs;
+        else if(SEQ == name) field = Field::Seq;
+        else if(JOB_ID == name)
+        {
+            /* static, resolved now */
+            text_.append(input, pos, begin - pos);
+            text_.append(quotedId, 1, quotedId.size() - 2);
+            pos = end + 1;
+            continue;
+        }
+        else
+        {
+            /* unknown, kept as is */
+            text_.append(input, pos, end + 1 - pos);
+            pos = end + 1;
+            continue;
+        }
+
+        /* numbers making up whole string lose the quotes */
+        text_.append(input, pos, begin - pos - (whole ? 1 : 0));
+        splices_.push_back({text_.size(), field, whole});
+        pos = end + 1 + (whole ? 1 : 0);
+    }
+
+    text_.append(input, pos, std::string::npos);
+}
+
+void PayloadTemplate::render(std::string &frame, const Fields &fields) const
+{
+    frame.clear();
+
+    std::size_t pos = 0;
+
+    for(const auto &splice : splices_)
+    {
+        frame.append(text_, pos, splice.offset - pos);
+        pos = splice.offset;
+
+        switch(splice.field)
+        {
+            case Field::ScheduledTs:
+                append(frame, fields.scheduledMs / 1000);
+                break;
+            case Field::ScheduledMs:
+                append(frame, fields.scheduledMs);
+                break;
+            case Field::Seq:
+                append(frame, fields.seq);
+                break;
+        }
+    }
+
+    frame.append(text_, pos, std::string::npos);
+}
+
+std::string PayloadTemplate::source() const
+{
+    std::string source;
+    std::size_t pos = 0;
+
+    for(const auto &splice : splices_)
+    {
+        source.append(text_, pos, splice.offset - pos);
+        pos = splice.offset;
+
+        if(splice.whole) source += '"';
+        source += PLACEHOLDER_BEGIN;
+
+        switch(splice.field)
+        {
+            case Field::ScheduledTs:
+                source += SCHEDULED_TS;
+                break;
+            case Field::ScheduledMs:
+                source += SCHEDULED_MS;
+                break;
+            case Field::Seq:
+                source += SEQ;
+                break;
+        }
+
+        source += PLACEHOLDER_END;
+        if(splice.whole) source += '"';
+    }
+
+    source.append(text_, pos, std::string::npos);
+    return source;
+}
+
+std::ostream &operator<<(std::ostream &os, const PayloadTemplate &payload)
+{
+    return os << payload.source();
+}
+
+} /* cron */
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "json.h"
+
+namespace cron {
+
+/* payload serialized once at load time and split at placeholders
+ *
+ * Placeholders are recognized inside json strings:
+ *   ${scheduled_ts} scheduled instant, epoch seconds
+ *   ${scheduled_ms} scheduled instant, epoch milliseconds
+ *   ${seq}          dispatch sequence number
+ *   ${job_id}       job id (resolved at load time)
+ * Numeric placeholder making up a whole string is spliced as number,
+ * ("${seq}" -> 42), otherwise as text ("seq ${seq}" -> "seq 42"),
+ * in object keys always as text ({"${seq}": 1} -> {"42": 1}). */
+class PayloadTemplate
+{
+public:
+    struct Fields
+    {
+        uint64_t scheduledMs;
+        uint64_t seq;
+    };
+private:
+    enum class Field : uint8_t
+    {
+        ScheduledTs,
+        ScheduledMs,
+        Seq
+    };
+
+    struct Splice
+    {
+        /* offset into text_ */
+        std::size_t offset;
+        Field field;
+        /* whole json string, quotes were dropped */
+        bool whole;
+    };
+
+    /* static bytes, fields are inserted at splice offsets */
+    std::string text_;
+    std::vector<Splice> splices_;
+public:
+    /* empty frame */
+    PayloadTemplate() = default;
+    PayloadTemplate(const json &payload, const std::string &jobId);
+
+    /* no placeholders, text() is the frame */
+    bool isStatic() const {return splices_.empty();}
+    const std::string &text() const {return text_;}
+
+    /* frame capacity is reused */
+    void render(std::string &frame, const Fields &) const;
+
+    /* serialized payload with placeholders, job_id resolved,
+     * compiles to the same template */
+    std::string source() const;
+
+    friend
+    std::ostream &operator<<(std::ostream &, const PayloadTemplate &);
+};
+
+} /* cron */
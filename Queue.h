@@ -1,3 +1,5 @@
+#pragma once
+
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
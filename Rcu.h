@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/* read-copy-update pointer with a single reader thread
+ *
+ * Reader gets current version with a single atomic load and reports
+ * quiescent state (holds no version pointer) once per pass.
+ * Writers publish new immutable versions, a replaced version is
+ * deleted once reader went through quiescent state after replacement. */
+template <typename T>
+class Rcu
+{
+    using Retired = std::pair<uint64_t, std::unique_ptr<const T>>;
+
+    std::atomic<const T *> current_{nullptr};
+    /* number of reader quiescent states */
+    std::atomic<uint64_t> epoch_{0};
+    /* serializes writers, guards retired_ */
+    std::mutex mutex_;
+    std::vector<Retired> retired_;
+
+    void reclaim(uint64_t epoch)
+    {
+        retired_.erase(
+            std::remove_if(
+                std::begin(retired_), std::end(retired_),
+                [epoch](const Retired &retired){return retired.first < epoch;}),
+            std::end(retired_));
+    }
+public:
+    Rcu() = default;
+    Rcu(const Rcu &) = delete;
+    Rcu &operator=(const Rcu &) = delete;
+
+    ~Rcu()
+    {
+        delete current_.load();
+    }
+
+    /* reader side */
+    const T *read() const {return current_.load();}
+    void quiescent() {epoch_.fetch_add(1);}
+
+    /* writer side */
+    void publish(std::unique_ptr<const T> value)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        /* seq_cst: reader passing epoch read below
+         * is guaranteed to load new version afterwards */
+        const auto *prev = current_.exchange(value.release());
+        const auto epoch = epoch_.load();
+
+        if(prev) retired_.emplace_back(epoch, std::unique_ptr<const T>{prev});
+
+        reclaim(epoch);
+    }
+
+    void reclaim()
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        reclaim(epoch_.load());
+    }
+};
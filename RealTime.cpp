@@ -0,0 +1,113 @@
+#include <cerrno>
+#include <cstring>
+
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+
+#include "Ensure.h"
+#include "RealTime.h"
+
+namespace {
+
+constexpr std::size_t PREFAULT_STACK_MAX = 1024 * 1024;
+
+} /* namespace */
+
+void pinThread(const CpuSeq &cpus)
+{
+    ENSURE(!cpus.empty(), RuntimeError);
+
+    ::cpu_set_t set;
+
+    CPU_ZERO(&set);
+
+    for(const auto cpu : cpus)
+    {
+        ENSURE(0 <= cpu && CPU_SETSIZE > cpu, RuntimeError);
+        CPU_SET(cpu, &set);
+    }
+
+    const auto r = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+
+    errno = r;
+    ENSURE(0 == r, CRuntimeError);
+}
+
+CpuSeq threadCpus()
+{
+    ::cpu_set_t set;
+
+    const auto r = ::pthread_getaffinity_np(::pthread_self(), sizeof(set), &set);
+
+    errno = r;
+    ENSURE(0 == r, CRuntimeError);
+
+    CpuSeq cpus;
+
+    for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if(CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+
+    return cpus;
+}
+
+void setFifo(int priority)
+{
+    ENSURE(::sched_get_priority_min(SCHED_FIFO) <= priority, RuntimeError);
+    ENSURE(::sched_get_priority_max(SCHED_FIFO) >= priority, RuntimeError);
+
+    struct ::sched_param param;
+
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+
+    const auto r = ::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param);
+
+    errno = r;
+    ENSURE(0 == r, CRuntimeError);
+}
+
+void setTimerSlack(unsigned long nsecs)
+{
+    ENSURE(0 == ::prctl(PR_SET_TIMERSLACK, nsecs, 0, 0, 0), CRuntimeError);
+}
+
+void setNormal()
+{
+    struct ::sched_param param;
+
+    std::memset(&param, 0, sizeof(param));
+
+    const auto r = ::pthread_setschedparam(::pthread_self(), SCHED_OTHER, &param);
+
+    errno = r;
+    ENSURE(0 == r, CRuntimeError);
+
+    /* 0 is the default */
+    setTimerSlack(0);
+}
+
+void lockMemory()
+{
+    ENSURE(0 == ::mlockall(MCL_CURRENT | MCL_FUTURE), CRuntimeError);
+
+    /* freed memory is never returned, large blocks come from heap */
+    ::mallopt(M_TRIM_THRESHOLD, -1);
+    ::mallopt(M_MMAP_MAX, 0);
+}
+
+__attribute__((noinline))
+void prefaultStack(std::size_t size)
+{
+    ENSURE(PREFAULT_STACK_MAX >= size, RuntimeError);
+
+    char buf[PREFAULT_STACK_MAX];
+
+    std::memset(buf, 0, size);
+    /* keep the writes */
+    asm volatile("" : : "r"(buf) : "memory");
+}
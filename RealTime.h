@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/* low jitter setup of the calling thread/process */
+
+using CpuSeq = std::vector<int>;
+
+/* restrict calling thread to cpus */
+void pinThread(const CpuSeq &cpus);
+/* cpus calling thread may run on */
+CpuSeq threadCpus();
+/* SCHED_FIFO with priority for calling thread */
+void setFifo(int priority);
+/* wake up as close to requested time as the kernel allows */
+void setTimerSlack(unsigned long nsecs);
+/* SCHED_OTHER and default timer slack for calling thread,
+ * undoes what it inherited from a low jitter thread */
+void setNormal();
+/* lock current and future pages, keep freed heap mapped
+ * so allocations don't fault pages in again */
+void lockMemory();
+/* touch size bytes of calling thread stack */
+void prefaultStack(std::size_t size);
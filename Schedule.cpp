@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <array>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "Ensure.h"
+#include "Schedule.h"
+
+namespace {
+
+using Word = cron::Schedule::Word;
+
+constexpr std::size_t FIELDS = 6;
+
+/* slices per field, values are matched against tm fields as is
+ * (week day 1..7 and month 1..12 included) */
+constexpr std::size_t SECONDS = 60;
+constexpr std::size_t MINUTES = 60;
+constexpr std::size_t HOURS = 24;
+constexpr std::size_t WEEKDAYS = 8;
+constexpr std::size_t MONTHDAYS = 32;
+constexpr std::size_t MONTHS = 13;
+
+constexpr std::size_t SECONDS_BASE = 0;
+constexpr std::size_t MINUTES_BASE = SECONDS_BASE + SECONDS;
+constexpr std::size_t HOURS_BASE = MINUTES_BASE + MINUTES;
+constexpr std::size_t WEEKDAYS_BASE = HOURS_BASE + HOURS;
+constexpr std::size_t MONTHDAYS_BASE = WEEKDAYS_BASE + WEEKDAYS;
+constexpr std::size_t MONTHS_BASE = MONTHDAYS_BASE + MONTHDAYS;
+constexpr std::size_t SLICES = MONTHS_BASE + MONTHS;
+
+/* same as Schedule::Function */
+using Function = void (*)(const Word *const *in, Word *out, std::size_t words);
+
+/* all bits set for empty (any value) sequence */
+uint64_t toMask(const cron::AtValue::Seq &seq, std::size_t size)
+{
+    if(seq.empty()) return size < 64 ? (uint64_t(1) << size) - 1 : ~uint64_t(0);
+
+    uint64_t mask = 0;
+
+    for(const auto value : seq) mask |= uint64_t(1) << value;
+    return mask;
+}
+
+void andScalar(const Word *const *in, Word *out, std::size_t words)
+{
+    for(std::size_t w = 0; w < words; ++w)
+    {
+        out[w] = in[0][w] & in[1][w] & in[2][w] & in[3][w] & in[4][w] & in[5][w];
+    }
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse2")))
+void andSse2(const Word *const *in, Word *out, std::size_t words)
+{
+    constexpr std::size_t STEP = sizeof(__m128i) / sizeof(Word);
+
+    std::size_t w = 0;
+
+    for(; w + STEP <= words; w += STEP)
+    {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in[0] + w));
+
+        for(std::size_t f = 1; f < FIELDS; ++f)
+        {
+            v = _mm_and_si128(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(in[f] + w)));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + w), v);
+    }
+
+    for(; w < words; ++w)
+    {
+        out[w] = in[0][w] & in[1][w] & in[2][w] & in[3][w] & in[4][w] & in[5][w];
+    }
+}
+
+__attribute__((target("avx2")))
+void andAvx2(const Word *const *in, Word *out, std::size_t words)
+{
+    constexpr std::size_t STEP = sizeof(__m256i) / sizeof(Word);
+
+    std::size_t w = 0;
+
+    for(; w + STEP <= words; w += STEP)
+    {
+        auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in[0] + w));
+
+        for(std::size_t f = 1; f < FIELDS; ++f)
+        {
+            v = _mm256_and_si256(
+                v, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in[f] + w)));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + w), v);
+    }
+
+    for(; w < words; ++w)
+    {
+        out[w] = in[0][w] & in[1][w] & in[2][w] & in[3][w] & in[4][w] & in[5][w];
+    }
+}
+
+#endif
+
+Function function(cron::Schedule::Kernel kernel)
+{
+    using K = cron::Schedule::Kernel;
+
+    switch(kernel)
+    {
+#if defined(__x86_64__)
+        case K::Avx2: return andAvx2;
+        case K::Sse2: return andSse2;
+#else
+        case K::Avx2:
+        case K::Sse2:
+            break;
+#endif
+        case K::Scalar: return andScalar;
+    }
+
+    return nullptr;
+}
+
+Function select()
+{
+    using K = cron::Schedule::Kernel;
+
+    if(cron::Schedule::supported(K::Avx2)) return function(K::Avx2);
+    if(cron::Schedule::supported(K::Sse2)) return function(K::Sse2);
+    return function(K::Scalar);
+}
+
+Function selected()
+{
+    static const Function selected = select();
+
+    return selected;
+}
+
+} /* namespace */
+
+namespace cron {
+
+Schedule::Schedule(const std::vector<const Job *> &jobSeq):
+    size_{jobSeq.size()},
+    words_{(jobSeq.size() + WORD_BITS - 1) / WORD_BITS},
+    slices_(SLICES * words_, 0)
+{
+    /* transposed per block of WORD_BITS jobs in cache,
+     * then written once per slice */
+    std::array<Word, SLICES> block;
+
+    for(std::size_t w = 0; w < words_; ++w)
+    {
+        block.fill(0);
+
+        const auto end = std::min(size_, (w + 1) * WORD_BITS);
+
+        for(auto i = w * WORD_BITS; i < end; ++i)
+        {
+            const auto &atValue = jobSeq[i]->atValue();
+            const auto bit = Word(1) << (i % WORD_BITS);
+            const auto set =
+                [&block, bit](uint64_t mask, std::size_t base)
+                {
+                    for(; mask; mask &= mask - 1) block[base + __builtin_ctzll(mask)] |= bit;
+                };
+
+            set(toMask(atValue.seconds(), SECONDS), SECONDS_BASE);
+            set(toMask(atValue.minutes(), MINUTES), MINUTES_BASE);
+            set(toMask(atValue.hours(), HOURS), HOURS_BASE);
+            set(toMask(atValue.weekdays(), WEEKDAYS), WEEKDAYS_BASE);
+            set(toMask(atValue.monthdays(), MONTHDAYS), MONTHDAYS_BASE);
+            set(toMask(atValue.months(), MONTHS), MONTHS_BASE);
+        }
+
+        for(std::size_t s = 0; s < SLICES; ++s) slices_[s * words_ + w] = block[s];
+    }
+}
+
+void Schedule::match(const std::tm &tm, Bitmap &due) const
+{
+    match(tm, due, selected());
+}
+
+void Schedule::match(const std::tm &tm, Bitmap &due, Kernel k) const
+{
+    ENSURE(supported(k), RuntimeError);
+    match(tm, due, function(k));
+}
+
+void Schedule::match(const std::tm &tm, Bitmap &due, Function f) const
+{
+    due.resize(words_);
+
+    if(!words_) return;
+
+    const Word *const in[FIELDS] =
+    {
+        /* leap second (never given by POSIX time) is matched as 59 */
+        slice(SECONDS_BASE + std::size_t(std::min(tm.tm_sec, int(SECONDS) - 1))),
+        slice(MINUTES_BASE + std::size_t(tm.tm_min)),
+        slice(HOURS_BASE + std::size_t(tm.tm_hour)),
+        slice(WEEKDAYS_BASE + std::size_t(tm.tm_wday)),
+        slice(MONTHDAYS_BASE + std::size_t(tm.tm_mday)),
+        slice(MONTHS_BASE + std::size_t(tm.tm_mon))
+    };
+
+    f(in, due.data(), words_);
+}
+
+bool Schedule::supported(Kernel kernel)
+{
+    switch(kernel)
+    {
+        case Kernel::Scalar:
+            return true;
+#if defined(__x86_64__)
+        case Kernel::Sse2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case Kernel::Avx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#else
+        case Kernel::Sse2:
+        case Kernel::Avx2:
+            return false;
+#endif
+    }
+
+    return false;
+}
+
+} /* cron */
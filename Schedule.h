@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+#include "Job.h"
+
+namespace cron {
+
+/* columnar (bit sliced) schedule of a job sequence
+ *
+ * Every value of every civil time field has a bitmap over jobs,
+ * bit i is set if job i matches the value (any value if the field
+ * is not given). Jobs due at a second are the AND of six bitmaps,
+ * evaluated by a SIMD kernel picked at run time. */
+class Schedule
+{
+public:
+    using Word = uint64_t;
+    using Bitmap = std::vector<Word>;
+
+    static constexpr std::size_t WORD_BITS = 64;
+
+    /* AND of the six slices */
+    enum class Kernel
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+private:
+    std::size_t size_ = 0;
+    std::size_t words_ = 0;
+    /* all slices, words_ words each, ordered by field then value */
+    Bitmap slices_;
+
+    const Word *slice(std::size_t index) const {return slices_.data() + index * words_;}
+
+    using Function = void (*)(const Word *const *in, Word *out, std::size_t words);
+
+    void match(const std::tm &, Bitmap &due, Function) const;
+public:
+    Schedule() = default;
+    explicit Schedule(const std::vector<const Job *> &);
+
+    /* number of jobs */
+    std::size_t size() const {return size_;}
+
+    /* bit i of due is set if job i is due at civil time tm,
+     * by the best kernel the cpu supports */
+    void match(const std::tm &, Bitmap &due) const;
+    /* by given kernel, it must be supported */
+    void match(const std::tm &, Bitmap &due, Kernel) const;
+
+    static bool supported(Kernel);
+};
+
+} /* cron */
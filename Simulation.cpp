@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <iterator>
+
+#include "Simulation.h"
+
+namespace {
+
+/* all bits set for empty (any value) sequence */
+uint64_t toMask(const cron::AtValue::Seq &seq, std::size_t size)
+{
+    if(seq.empty()) return (uint64_t(1) << size) - 1;
+
+    uint64_t mask = 0;
+
+    for(const auto value : seq) mask |= uint64_t(1) << value;
+    return mask;
+}
+
+} /* namespace */
+
+namespace cron {
+
+template <std::size_t N>
+void Simulation::Index<N>::clear()
+{
+    for(auto &i : values) i.clear();
+    wildcard.clear();
+}
+
+template <std::size_t N>
+void Simulation::Index<N>::add(uint64_t mask, std::size_t index)
+{
+    if((uint64_t(1) << N) - 1 == mask)
+    {
+        wildcard.push_back(index);
+        return;
+    }
+
+    for(; mask; mask &= mask - 1) values[__builtin_ctzll(mask)].push_back(index);
+}
+
+template <std::size_t N>
+void Simulation::Index<N>::match(int value, IndexSeq &seq) const
+{
+    const auto &v = values[value];
+
+    seq.clear();
+    std::merge(
+        std::begin(v), std::end(v),
+        std::begin(wildcard), std::end(wildcard),
+        std::back_inserter(seq));
+}
+
+Simulation::Simulation(JobPtrSeq jobSeq): jobSeq_{std::move(jobSeq)}
+{
+    maskSeq_.reserve(jobSeq_.size());
+
+    for(const auto *job : jobSeq_)
+    {
+        const auto &atValue = job->atValue();
+
+        maskSeq_.push_back(
+            {
+                toMask(atValue.seconds(), 60),
+                toMask(atValue.minutes(), 60),
+                toMask(atValue.hours(), 24)
+            });
+    }
+}
+
+void Simulation::day(const std::tm &tm)
+{
+    hours_.clear();
+
+    for(std::size_t i = 0; i < jobSeq_.size(); ++i)
+    {
+        const auto &atValue = jobSeq_[i]->atValue();
+
+        if(atValue.expiredDay(tm)) hours_.add(maskSeq_[i].hours, i);
+    }
+}
+
+void Simulation::hour(const std::tm &tm)
+{
+    hours_.match(tm.tm_hour, candidates_);
+    minutes_.clear();
+
+    for(const auto i : candidates_) minutes_.add(maskSeq_[i].minutes, i);
+}
+
+void Simulation::minute(const std::tm &tm)
+{
+    minutes_.match(tm.tm_min, candidates_);
+    seconds_.clear();
+
+    for(const auto i : candidates_) seconds_.add(maskSeq_[i].seconds, i);
+}
+
+void Simulation::run(VirtualTime &time, Clock::time_point to, const Fire &fire)
+{
+    using namespace std::chrono;
+
+    const auto from = time.now();
+
+    /* day/hour indexes depend only on civil date/hour value,
+     * DST repeated hour reuses them */
+    int lastYear = -1, lastYday = -1, lastHour = -1;
+
+    /* one civil minute per step, offsets are not assumed
+     * to be whole minutes */
+    for(auto at = time_point_cast<seconds>(from); to > at;)
+    {
+        time.set(at);
+
+        const auto tm = TimeSource::localtime(at);
+
+        if(lastYear != tm.tm_year || lastYday != tm.tm_yday)
+        {
+            lastYear = tm.tm_year;
+            lastYday = tm.tm_yday;
+            lastHour = -1;
+            day(tm);
+        }
+
+        if(lastHour != tm.tm_hour)
+        {
+            lastHour = tm.tm_hour;
+            hour(tm);
+        }
+
+        minute(tm);
+
+        for(auto sec = tm.tm_sec; 60 > sec && to > at; ++sec, at += seconds{1})
+        {
+            if(from > at) continue;
+
+            seconds_.match(sec, due_);
+
+            for(const auto i : due_) fire(at, i);
+        }
+    }
+
+    time.set(to);
+}
+
+} /* cron */
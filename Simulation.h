@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Clock.h"
+#include "Job.h"
+
+namespace cron {
+
+/* replays recurring jobs over a time range in virtual time
+ *
+ * Jobs are narrowed per civil day, hour and minute and indexed
+ * by the values they fire at, so the cost follows the number of
+ * firings rather than number of jobs times number of seconds. */
+class Simulation
+{
+public:
+    using JobPtrSeq = std::vector<const Job *>;
+    /* firing time, index into jobs() */
+    using Fire = std::function<void(Clock::time_point, std::size_t)>;
+private:
+    using IndexSeq = std::vector<std::size_t>;
+
+    /* bit per matching value, kept apart from jobs
+     * so the per minute pass stays in cache */
+    struct Mask
+    {
+        uint64_t seconds;
+        uint64_t minutes;
+        uint64_t hours;
+    };
+
+    template <std::size_t N>
+    struct Index
+    {
+        /* jobs per value, wildcard holds jobs matching any value */
+        std::array<IndexSeq, N> values;
+        IndexSeq wildcard;
+
+        void clear();
+        void add(uint64_t mask, std::size_t);
+        /* jobs matching value, ordered by index */
+        void match(int value, IndexSeq &) const;
+    };
+
+    JobPtrSeq jobSeq_;
+    std::vector<Mask> maskSeq_;
+    Index<24> hours_;
+    Index<60> minutes_;
+    Index<60> seconds_;
+    IndexSeq candidates_;
+    IndexSeq due_;
+
+    void day(const std::tm &);
+    void hour(const std::tm &);
+    void minute(const std::tm &);
+public:
+    explicit Simulation(JobPtrSeq);
+
+    const JobPtrSeq &jobs() const {return jobSeq_;}
+
+    /* fire every job due in [time.now(), to),
+     * time is moved forward while replaying */
+    void run(VirtualTime &time, Clock::time_point to, const Fire &);
+};
+
+} /* cron */
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Ensure.h"
+
+/* hierarchical timing wheel
+ *
+ * LEVELS wheels of SLOTS slots each, level L slot covers SLOTS^L ticks.
+ * A timer is kept at the highest level where its expiry differs from
+ * current time and is moved down (cascaded) when time reaches its slot,
+ * it ends up in level 0 slot that fires exactly at expiry.
+ * Timers live in a pool and are linked by 32 bit indexes,
+ * insert and cancel are O(1), advance skips empty slots.
+ * Free nodes are linked in both directions, so a timer can be
+ * restored under its handle (handed over from another wheel). */
+template <typename T>
+class TimingWheel
+{
+public:
+    using Tick = uint64_t;
+    /* generation << 32 | index, stale handles are rejected by cancel() */
+    using Handle = uint64_t;
+private:
+    static constexpr int BITS = 6;
+    static constexpr int SLOTS = 1 << BITS;
+    /* 42 bits of ticks, 139 years of milliseconds */
+    static constexpr int LEVELS = 7;
+    /* timers expired on insert are fired on next advance() */
+    static constexpr int DUE = LEVELS * SLOTS;
+    static constexpr uint16_t FREE = std::numeric_limits<uint16_t>::max();
+    static constexpr uint32_t NIL = std::numeric_limits<uint32_t>::max();
+
+    struct Node
+    {
+        Tick expiry = 0;
+        uint32_t next = NIL;
+        uint32_t prev = NIL;
+        uint32_t generation = 0;
+        /* owning list (level * SLOTS + slot or DUE), FREE if not used */
+        uint16_t list = FREE;
+        T value;
+    };
+
+    std::vector<Node> nodes_;
+    uint32_t free_ = NIL;
+    std::array<uint32_t, LEVELS * SLOTS + 1> heads_;
+    /* non empty slots per level */
+    std::array<uint64_t, LEVELS> occupied_;
+    Tick now_;
+    std::size_t size_ = 0;
+
+    static int level(Tick diff)
+    {
+        return (63 - __builtin_clzll(diff)) / BITS;
+    }
+
+    void link(uint32_t index)
+    {
+        auto &node = nodes_[index];
+
+        int list = DUE;
+
+        if(node.expiry > now_)
+        {
+            /* checked by fits() on insert, kept by cascades */
+            const auto l = level(node.expiry ^ now_);
+
+            ASSERT(LEVELS > l);
+
+            const auto slot = int(node.expiry >> (l * BITS)) & (SLOTS - 1);
+
+            list = l * SLOTS + slot;
+            occupied_[l] |= uint64_t(1) << slot;
+        }
+
+        node.list = uint16_t(list);
+        node.prev = NIL;
+        node.next = heads_[list];
+        if(NIL != node.next) nodes_[node.next].prev = index;
+        heads_[list] = index;
+    }
+
+    void unlink(uint32_t index)
+    {
+        auto &node = nodes_[index];
+
+        if(NIL != node.prev) nodes_[node.prev].next = node.next;
+        else heads_[node.list] = node.next;
+
+        if(NIL != node.next) nodes_[node.next].prev = node.prev;
+
+        if(DUE != node.list && NIL == heads_[node.list])
+        {
+            occupied_[node.list / SLOTS] &= ~(uint64_t(1) << (node.list % SLOTS));
+        }
+    }
+
+    void release(uint32_t index)
+    {
+        auto &node = nodes_[index];
+
+        node.value = T{};
+        node.list = FREE;
+        ++node.generation;
+        node.prev = NIL;
+        node.next = free_;
+        if(NIL != free_) nodes_[free_].prev = index;
+        free_ = index;
+        --size_;
+    }
+
+    /* take free node off the free list */
+    void allocate(uint32_t index)
+    {
+        auto &node = nodes_[index];
+
+        if(NIL != node.prev) nodes_[node.prev].next = node.next;
+        else free_ = node.next;
+
+        if(NIL != node.next) nodes_[node.next].prev = node.prev;
+    }
+
+    /* node is allocated, value is set */
+    Handle add(uint32_t index, Tick expiry, T value)
+    {
+        auto &node = nodes_[index];
+
+        node.expiry = expiry;
+        node.value = std::move(value);
+        link(index);
+        ++size_;
+        return Handle(node.generation) << 32 | index;
+    }
+
+    /* detach whole list, occupied bit is cleared */
+    uint32_t take(int list)
+    {
+        const auto head = heads_[list];
+
+        heads_[list] = NIL;
+        if(DUE != list) occupied_[list / SLOTS] &= ~(uint64_t(1) << (list % SLOTS));
+        return head;
+    }
+
+    /* earliest tick something has to be done (fire or cascade) */
+    Tick next() const
+    {
+        if(NIL != heads_[DUE]) return now_;
+
+        auto tick = std::numeric_limits<Tick>::max();
+
+        for(int l = 0; l < LEVELS; ++l)
+        {
+            if(!occupied_[l]) continue;
+
+            const auto slot = Tick(__builtin_ctzll(occupied_[l]));
+            const auto shift = (l + 1) * BITS;
+            const auto base = (now_ >> shift) << shift;
+
+            tick = std::min(tick, base | (slot << (l * BITS)));
+        }
+
+        return tick;
+    }
+
+    void cascade()
+    {
+        for(int l = LEVELS - 1; l > 0; --l)
+        {
+            const auto mask = (Tick(1) << (l * BITS)) - 1;
+
+            if(now_ & mask) continue;
+
+            const auto slot = int(now_ >> (l * BITS)) & (SLOTS - 1);
+
+            for(auto index = take(l * SLOTS + slot); NIL != index;)
+            {
+                const auto next = nodes_[index].next;
+
+                link(index);
+                index = next;
+            }
+        }
+    }
+
+    template <typename F>
+    void fire(int list, F &f)
+    {
+        for(auto index = take(list); NIL != index;)
+        {
+            auto &node = nodes_[index];
+            const auto next = node.next;
+            const auto handle = Handle(node.generation) << 32 | index;
+            auto value = std::move(node.value);
+
+            /* released before callback, it is free to insert/cancel */
+            release(index);
+            f(handle, std::move(value));
+            index = next;
+        }
+    }
+public:
+    explicit TimingWheel(Tick now = 0): now_{now}
+    {
+        heads_.fill(uint32_t{NIL});
+        occupied_.fill(0);
+    }
+
+    Tick now() const {return now_;}
+    std::size_t size() const {return size_;}
+    bool empty() const {return 0 == size_;}
+
+    /* tick of next expiry or cascade (not later than any expiry),
+     * max Tick if empty */
+    Tick expiry() const {return next();}
+
+    void reserve(std::size_t size) {nodes_.reserve(size);}
+
+    /* expiry is due or differs from now in the low LEVELS * BITS bits
+     * only (up to 2^42 ticks ahead), insert() throws otherwise */
+    bool fits(Tick expiry) const
+    {
+        return expiry <= now_ || LEVELS > level(expiry ^ now_);
+    }
+
+    /* handle the next insert(Tick, T) returns */
+    Handle vacant() const
+    {
+        if(NIL != free_) return Handle(nodes_[free_].generation) << 32 | free_;
+        return Handle(nodes_.size());
+    }
+
+    /* f(Handle, const T &) for every pending timer, unordered */
+    template <typename F>
+    void forEach(F f) const
+    {
+        for(std::size_t index = 0; index < nodes_.size(); ++index)
+        {
+            const auto &node = nodes_[index];
+
+            if(FREE == node.list) continue;
+
+            f(Handle(node.generation) << 32 | index, node.value);
+        }
+    }
+
+    Handle insert(Tick expiry, T value)
+    {
+        /* before a node is taken */
+        ENSURE(fits(expiry), RuntimeError);
+
+        uint32_t index = free_;
+
+        if(NIL != index)
+        {
+            allocate(index);
+        }
+        else
+        {
+            ENSURE(NIL > nodes_.size(), RuntimeError);
+
+            index = uint32_t(nodes_.size());
+            nodes_.emplace_back();
+        }
+
+        return add(index, expiry, std::move(value));
+    }
+
+    /* under handle of a timer of another wheel,
+     * false if handle's node is in use */
+    bool insert(Handle handle, Tick expiry, T value)
+    {
+        const auto index = uint32_t(handle);
+
+        ENSURE(NIL > index, RuntimeError);
+        ENSURE(fits(expiry), RuntimeError);
+
+        /* nodes up to it are free */
+        while(nodes_.size() <= index)
+        {
+            const auto free = uint32_t(nodes_.size());
+
+            nodes_.emplace_back();
+            nodes_[free].next = free_;
+            if(NIL != free_) nodes_[free_].prev = free;
+            free_ = free;
+        }
+
+        if(FREE != nodes_[index].list) return false;
+
+        allocate(index);
+        nodes_[index].generation = uint32_t(handle >> 32);
+        add(index, expiry, std::move(value));
+        return true;
+    }
+
+    bool cancel(Handle handle)
+    {
+        const auto index = uint32_t(handle);
+
+        if(nodes_.size() <= index) return false;
+
+        const auto &node = nodes_[index];
+
+        if(FREE == node.list) return false;
+        if(uint32_t(handle >> 32) != node.generation) return false;
+
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    /* move time forward to tick, f(Handle, T &&) is called
+     * for every expired timer in expiry order (per tick) */
+    template <typename F>
+    void advance(Tick tick, F f)
+    {
+        fire(DUE, f);
+
+        while(now_ < tick)
+        {
+            now_ = std::min(next(), tick);
+            cascade();
+            fire(DUE, f);
+            fire(int(now_ & (SLOTS - 1)), f);
+        }
+    }
+};
@@ -0,0 +1,280 @@
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "Brokers.h"
+#include "testing.h"
+
+/* Brokers against in-process stand-in brokers */
+
+namespace {
+
+using namespace std::chrono;
+using cron::Brokers;
+using PayloadSeq = Brokers::PayloadSeq;
+
+constexpr auto TIMEOUT = milliseconds{50};
+constexpr std::size_t SENDERS = 2;
+/* past first backoff of a failed broker */
+constexpr auto BACKOFF = milliseconds{150};
+
+/* stand-in broker per address: replies, fails or hangs */
+class StandIns
+{
+public:
+    enum class Mode {Reply, Fail, Hang};
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::map<std::string, Mode> modes_;
+    std::map<std::string, milliseconds> delays_;
+    std::map<std::string, int> delivered_;
+public:
+    void set(const std::string &address, Mode mode, milliseconds delay = milliseconds{0})
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+
+            modes_[address] = mode;
+            delays_[address] = delay;
+        }
+
+        cond_.notify_all();
+    }
+
+    int delivered(const std::string &address)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        return delivered_[address];
+    }
+
+    Brokers::Transport transport()
+    {
+        return
+            [this](const std::string &address, const std::string &, const PayloadSeq &)
+            {
+                std::unique_lock<std::mutex> lock{mutex_};
+
+                ++delivered_[address];
+                cond_.wait(lock, [&](){return Mode::Hang != modes_[address];});
+
+                if(Mode::Fail == modes_[address]) throw std::runtime_error{address + " down"};
+
+                const auto delay = delays_[address];
+
+                lock.unlock();
+                std::this_thread::sleep_for(delay);
+                return PayloadSeq{"200", address};
+            };
+    }
+};
+
+const Brokers::Stats &stats(const std::vector<Brokers::Stats> &seq, const std::string &address)
+{
+    for(const auto &i : seq)
+    {
+        if(address == i.address) return i;
+    }
+
+    throw std::runtime_error{"no " + address};
+}
+
+void fastest()
+{
+    StandIns standIns;
+
+    standIns.set("slow", StandIns::Mode::Reply, milliseconds{10});
+    standIns.set("fast", StandIns::Mode::Reply);
+
+    Brokers brokers{{"slow", "fast"}, TIMEOUT, SENDERS, standIns.transport()};
+
+    int fast = 0;
+
+    for(int i = 0; i < 20; ++i) fast += "fast" == brokers.exec("s", {"p"})[1];
+
+    CHECK(18 <= fast);
+}
+
+void failover()
+{
+    StandIns standIns;
+
+    standIns.set("down", StandIns::Mode::Fail);
+    standIns.set("up", StandIns::Mode::Reply);
+
+    Brokers brokers{{"down", "up"}, TIMEOUT, SENDERS, standIns.transport()};
+
+    CHECK("up" == brokers.exec("s", {"p"})[1]);
+    CHECK(!stats(brokers.stats(), "down").healthy);
+    /* in backoff, not tried */
+    CHECK("up" == brokers.exec("s", {"p"})[1]);
+    CHECK(1 == standIns.delivered("down"));
+}
+
+void recovery()
+{
+    StandIns standIns;
+
+    standIns.set("flaky", StandIns::Mode::Fail);
+    standIns.set("up", StandIns::Mode::Reply, milliseconds{5});
+
+    Brokers brokers{{"flaky", "up"}, TIMEOUT, SENDERS, standIns.transport()};
+
+    CHECK("up" == brokers.exec("s", {"p"})[1]);
+
+    standIns.set("flaky", StandIns::Mode::Reply);
+    std::this_thread::sleep_for(BACKOFF);
+
+    /* probed past backoff although "up" is healthy */
+    CHECK("flaky" == brokers.exec("s", {"p"})[1]);
+    CHECK(stats(brokers.stats(), "flaky").healthy);
+}
+
+/* senders of a broker work concurrently */
+void concurrent()
+{
+    constexpr auto DELAY = milliseconds{300};
+    constexpr std::size_t REQUESTS = 8;
+
+    StandIns standIns;
+
+    standIns.set("w", StandIns::Mode::Reply, DELAY);
+
+    Brokers brokers{{"w"}, TIMEOUT, REQUESTS, standIns.transport()};
+
+    const auto start = steady_clock::now();
+    std::vector<std::future<std::string>> replies;
+
+    for(std::size_t i = 0; i < REQUESTS; ++i)
+    {
+        replies.push_back(
+            std::async(
+                std::launch::async,
+                [&brokers](){return brokers.exec("s", {"p"})[1];}));
+    }
+
+    for(auto &reply : replies) CHECK("w" == reply.get());
+
+    CHECK(2 * DELAY > steady_clock::now() - start);
+    CHECK(int(REQUESTS) == standIns.delivered("w"));
+}
+
+/* reply later than timeout is waited for, not sent again */
+void slowReply()
+{
+    StandIns standIns;
+
+    standIns.set("slow", StandIns::Mode::Reply, 4 * TIMEOUT);
+    standIns.set("other", StandIns::Mode::Reply);
+
+    Brokers brokers{{"slow", "other"}, TIMEOUT, SENDERS, standIns.transport()};
+
+    CHECK("slow" == brokers.exec("s", {"p"})[1]);
+    CHECK(0 == standIns.delivered("other"));
+    CHECK(stats(brokers.stats(), "slow").healthy);
+}
+
+/* broker with every sender stuck is passed over, not failed */
+void busy()
+{
+    StandIns standIns;
+
+    standIns.set("stuck", StandIns::Mode::Hang);
+    standIns.set("up", StandIns::Mode::Reply);
+
+    {
+        Brokers brokers{{"stuck", "up"}, TIMEOUT, 1, standIns.transport()};
+
+        auto stuck =
+            std::async(
+                std::launch::async,
+                [&brokers](){return brokers.exec("s", {"p"})[1];});
+
+        while(!standIns.delivered("stuck")) std::this_thread::sleep_for(milliseconds{1});
+
+        /* stuck has no free sender */
+        CHECK("up" == brokers.exec("s", {"p"})[1]);
+        CHECK(0 == stats(brokers.stats(), "stuck").busy);
+
+        /* up has no free sender either, both time out queued */
+        standIns.set("up", StandIns::Mode::Hang);
+
+        auto up =
+            std::async(
+                std::launch::async,
+                [&brokers](){return brokers.exec("s", {"p"})[1];});
+
+        while(2 > standIns.delivered("up")) std::this_thread::sleep_for(milliseconds{1});
+
+        bool thrown = false;
+
+        try
+        {
+            brokers.exec("s", {"p"});
+        }
+        catch(const std::exception &)
+        {
+            thrown = true;
+        }
+
+        CHECK(thrown);
+        CHECK(1 == stats(brokers.stats(), "stuck").busy);
+        CHECK(1 == stats(brokers.stats(), "up").busy);
+        CHECK(stats(brokers.stats(), "stuck").healthy);
+
+        standIns.set("stuck", StandIns::Mode::Reply);
+        standIns.set("up", StandIns::Mode::Reply);
+
+        /* taken requests complete on their own broker */
+        CHECK("stuck" == stuck.get());
+        CHECK("up" == up.get());
+    }
+
+    /* cancelled requests were not delivered once senders went on */
+    CHECK(1 == standIns.delivered("stuck"));
+    CHECK(2 == standIns.delivered("up"));
+}
+
+void unavailable()
+{
+    StandIns standIns;
+
+    standIns.set("a", StandIns::Mode::Fail);
+    standIns.set("b", StandIns::Mode::Fail);
+
+    Brokers brokers{{"a", "b"}, TIMEOUT, SENDERS, standIns.transport()};
+
+    bool thrown = false;
+
+    try
+    {
+        brokers.exec("s", {"p"});
+    }
+    catch(const std::exception &)
+    {
+        thrown = true;
+    }
+
+    CHECK(thrown);
+}
+
+} /* namespace */
+
+int main()
+{
+    fastest();
+    failover();
+    recovery();
+    concurrent();
+    slowReply();
+    busy();
+    unavailable();
+
+    return test::result();
+}
@@ -1,30 +1,189 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ctime>
 #include <iostream>
 
+#include <getopt.h>
 #include <unistd.h>
 
 #include "Cron.h"
 
 namespace {
 
+constexpr auto ADMIN_SERVICE = "cron.admin";
+constexpr auto RANGE_SEPARATOR = "..";
+constexpr auto LIMIT_SEPARATOR = ':';
+constexpr std::size_t BATCH_LIMIT = 64;
+constexpr long RING_CAPACITY = 1l << 24;
+constexpr auto BROKER_SEPARATOR = ',';
+
+const struct option OPTIONS[] =
+{
+    {"simulate", required_argument, nullptr, 'S'},
+    {"count", no_argument, nullptr, 'c'},
+    {"low-jitter", optional_argument, nullptr, 'L'},
+    {"fifo", required_argument, nullptr, 'F'},
+    {"batch", required_argument, nullptr, 'B'},
+    {"ring", required_argument, nullptr, 'R'},
+    {"broker-timeout", required_argument, nullptr, 'T'},
+    {"handover", required_argument, nullptr, 'H'},
+    {"lease", required_argument, nullptr, 'l'},
+    {"dispatch-threads", required_argument, nullptr, 'D'},
+    {"max-in-flight", required_argument, nullptr, 'M'},
+    {nullptr, 0, nullptr, 0}
+};
+
 void help(const char *argv0, const char *message = nullptr)
 {
     if(message) std::cout << "WARNING: " << message << '\n';
 
     std::cout
         << argv0
-        << " -a broker_address"
+        << " -a broker_address[,broker_address]..."
+        << " -p path"
+        << " [-w admin_service]"
+        << " [-s state_path]"
+        << " [--low-jitter[=CPUS] [--fifo PRIORITY]]"
+        << " [--batch SERVICE[:MAX]]..."
+        << " [--ring NAME[:CAPACITY]]"
+        << " [--broker-timeout MS]"
+        << " [--handover SOCKET]"
+        << " [--lease PATH]"
+        << " [--dispatch-threads N] [--max-in-flight SERVICE:MAX]..."
+        << '\n'
+        << argv0
         << " -p path"
+        << " [-s state_path]"
+        << " --simulate FROM..TO"
+        << " [--count]"
+        << '\n'
+        << "    FROM/TO: epoch seconds, YYYY-MM-DD or YYYY-MM-DDTHH:MM:SS (local)"
+        << '\n'
+        << "    broker_address: -a may be repeated, requests go to the fastest healthy broker,"
+        << '\n'
+        << "        next one is tried on failure or if it takes no request within MS"
+        << '\n'
+        << "        (1000 by default), a request taken is waited for until its reply,"
+        << '\n'
+        << "        admin service is served on each of them"
+        << '\n'
+        << "    SOCKET: running process listening there hands its state over"
+        << " and exits,"
+        << '\n'
+        << "        new process listens there for its own successor"
+        << '\n'
+        << "    PATH: instances sharing a lease file, one fires while others stand by"
+        << '\n'
+        << "        with jobs loaded and take over when it exits or stops renewing (3 s)"
+        << '\n'
+        << "    CPUS: cpus of the threads firing and sending requests, comma separated,"
+        << '\n'
+        << "        ranges as 0-3"
+        << '\n'
+        << "    SERVICE: due jobs of a tick go in one request, frame per job (MAX "
+        << BATCH_LIMIT << " by default),"
+        << '\n'
+        << "        worker replies with one status frame per job (200 if done)"
+        << '\n'
+        << "    N: requests are sent by N threads (by the firing thread by default),"
+        << '\n'
+        << "        a job fired while its previous request is outstanding is sent,"
+        << " skipped or queued (one)"
+        << '\n'
+        << "        as its overlap says, requests of SERVICE past MAX in flight"
+        << " wait for one to complete"
+        << '\n'
+        << "    NAME: shared memory segment (as /cron) firings are published to,"
+        << " CAPACITY records (power of 2),"
+        << '\n'
+        << "        existing one is written on (successor, standby), it is kept on exit"
         << std::endl;
 }
 
+/* false on failure */
+bool parseCpus(const std::string &value, CpuSeq &cpus)
+{
+    std::size_t begin = 0;
+
+    while(begin < value.size())
+    {
+        auto end = value.find(',', begin);
+
+        if(std::string::npos == end) end = value.size();
+
+        const auto item = value.substr(begin, end - begin);
+        const auto dash = item.find('-');
+
+        try
+        {
+            const auto first = std::stoi(item.substr(0, dash));
+            const auto last =
+                std::string::npos == dash ? first : std::stoi(item.substr(dash + 1));
+
+            if(0 > first || first > last) return false;
+
+            for(auto cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        }
+        catch(const std::exception &)
+        {
+            return false;
+        }
+
+        begin = end + 1;
+    }
+
+    return !cpus.empty();
+}
+
+/* 0 on failure */
+std::time_t parseTime(const std::string &value)
+{
+    if(value.empty()) return 0;
+
+    if(std::all_of(
+        std::begin(value), std::end(value),
+        [](unsigned char c){return std::isdigit(c);}))
+    {
+        return std::time_t(std::stoll(value));
+    }
+
+    std::tm tm;
+
+    std::memset(&tm, 0, sizeof(tm));
+
+    const auto *end = ::strptime(value.c_str(), "%Y-%m-%dT%H:%M:%S", &tm);
+
+    if(!end)
+    {
+        std::memset(&tm, 0, sizeof(tm));
+        end = ::strptime(value.c_str(), "%Y-%m-%d", &tm);
+    }
+
+    if(!end || *end) return 0;
+
+    /* let mktime figure out DST */
+    tm.tm_isdst = -1;
+
+    const auto time = std::mktime(&tm);
+
+    return -1 == time ? 0 : time;
+}
+
 } /* namespace */
 
 int main(int argc, char *const argv[])
 {
-    std::string brokerAddress;
-    std::string path;
+    using namespace cron;
+
+    Cron::Config config;
 
-    for(int c; -1 != (c = ::getopt(argc, argv, "ha:p:"));)
+    config.adminService = ADMIN_SERVICE;
+
+    std::string simulate;
+    bool count = false;
+
+    for(int c; -1 != (c = ::getopt_long(argc, argv, "ha:p:w:s:", OPTIONS, nullptr));)
     {
         switch(c)
         {
@@ -33,10 +192,139 @@ int main(int argc, char *const argv[])
                 return EXIT_SUCCESS;
                 break;
             case 'a':
-                brokerAddress = optarg ? optarg : "";
+            {
+                const std::string value = optarg ? optarg : "";
+                std::size_t begin = 0;
+
+                while(begin <= value.size())
+                {
+                    auto end = value.find(BROKER_SEPARATOR, begin);
+
+                    if(std::string::npos == end) end = value.size();
+
+                    if(begin == end)
+                    {
+                        help(argv[0], "invalid broker address");
+                        return EXIT_FAILURE;
+                    }
+
+                    config.brokers.push_back(value.substr(begin, end - begin));
+                    begin = end + 1;
+                }
+                break;
+            }
+            case 'T':
+                config.brokerTimeout = std::chrono::milliseconds{optarg ? std::atol(optarg) : 0};
+                if(0 >= config.brokerTimeout.count())
+                {
+                    help(argv[0], "invalid broker timeout");
+                    return EXIT_FAILURE;
+                }
                 break;
             case 'p':
-                path = optarg ? optarg : "";
+                config.basePath = optarg ? optarg : "";
+                break;
+            case 'w':
+                config.adminService = optarg ? optarg : "";
+                break;
+            case 's':
+                config.statePath = optarg ? optarg : "";
+                break;
+            case 'S':
+                simulate = optarg ? optarg : "";
+                break;
+            case 'c':
+                count = true;
+                break;
+            case 'L':
+                config.lowJitter = true;
+                if(optarg && !parseCpus(optarg, config.cpus))
+                {
+                    help(argv[0], "invalid cpu list");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'B':
+            {
+                const std::string value = optarg ? optarg : "";
+                const auto separator = value.find(LIMIT_SEPARATOR);
+                const auto service = value.substr(0, separator);
+                const auto limit =
+                    std::string::npos == separator
+                    ? int(BATCH_LIMIT)
+                    : std::atoi(value.c_str() + separator + 1);
+
+                if(service.empty() || 0 >= limit)
+                {
+                    help(argv[0], "invalid batch");
+                    return EXIT_FAILURE;
+                }
+
+                config.batch[service] = std::size_t(limit);
+                break;
+            }
+            case 'R':
+            {
+                const std::string value = optarg ? optarg : "";
+                const auto separator = value.find(LIMIT_SEPARATOR);
+                const auto capacity =
+                    std::string::npos == separator
+                    ? long(config.ringCapacity)
+                    : std::atol(value.c_str() + separator + 1);
+
+                config.ring = value.substr(0, separator);
+
+                if(
+                    config.ring.empty()
+                    || 0 >= capacity
+                    || RING_CAPACITY < capacity
+                    || (capacity & (capacity - 1)))
+                {
+                    help(argv[0], "invalid ring");
+                    return EXIT_FAILURE;
+                }
+
+                config.ringCapacity = uint32_t(capacity);
+                break;
+            }
+            case 'H':
+                config.handoverPath = optarg ? optarg : "";
+                break;
+            case 'l':
+                config.leasePath = optarg ? optarg : "";
+                break;
+            case 'D':
+                config.dispatchThreads = std::size_t(optarg ? std::max(std::atoi(optarg), 0) : 0);
+                if(!config.dispatchThreads)
+                {
+                    help(argv[0], "invalid dispatch threads");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'M':
+            {
+                const std::string value = optarg ? optarg : "";
+                const auto separator = value.find(LIMIT_SEPARATOR);
+                const auto service = value.substr(0, separator);
+                const auto limit =
+                    std::string::npos == separator ? 0 : std::atoi(value.c_str() + separator + 1);
+
+                if(service.empty() || 0 >= limit)
+                {
+                    help(argv[0], "invalid in-flight limit");
+                    return EXIT_FAILURE;
+                }
+
+                config.inFlight[service] = std::size_t(limit);
+                break;
+            }
+            case 'F':
+                config.priority = optarg ? std::atoi(optarg) : 0;
+                if(0 >= config.priority)
+                {
+                    help(argv[0], "invalid priority");
+                    return EXIT_FAILURE;
+                }
                 break;
             case ':':
             case '?':
@@ -47,9 +335,31 @@ int main(int argc, char *const argv[])
         }
     }
 
+    std::time_t from = 0, to = 0;
+
+    if(!simulate.empty())
+    {
+        const auto separator = simulate.find(RANGE_SEPARATOR);
+
+        if(std::string::npos != separator)
+        {
+            from = parseTime(simulate.substr(0, separator));
+            to = parseTime(simulate.substr(separator + std::strlen(RANGE_SEPARATOR)));
+        }
+
+        if(!from || !to || from >= to)
+        {
+            help(argv[0], "invalid simulation range");
+            return EXIT_FAILURE;
+        }
+    }
+
     if(
-        brokerAddress.empty()
-        || path.empty())
+        (simulate.empty() && config.brokers.empty())
+        || config.basePath.empty()
+        || config.adminService.empty()
+        || (config.priority && !config.lowJitter)
+        || (!simulate.empty() && config.lowJitter))
     {
         help(argv[0], "missing/invalid required arguments");
         return EXIT_FAILURE;
@@ -57,9 +367,14 @@ int main(int argc, char *const argv[])
 
     try
     {
-        using namespace cron;
+        Cron cron(config);
+
+        if(!simulate.empty())
+        {
+            cron.simulate(Clock::from_time_t(from), Clock::from_time_t(to), count);
+            return EXIT_SUCCESS;
+        }
 
-        Cron cron(brokerAddress, path);
         cron.exec();
     }
     catch(const std::exception &except)
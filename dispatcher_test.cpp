@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Dispatcher.h"
+#include "testing.h"
+
+/* Dispatcher overlap policies and in-flight limits */
+
+namespace {
+
+using namespace std::chrono;
+using cron::Dispatcher;
+using cron::Overlap;
+
+constexpr std::size_t THREADS = 4;
+
+/* sends block until opened, counts sends running at once */
+class Gate
+{
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool open_ = false;
+    int running_ = 0;
+    int maxRunning_ = 0;
+    int sent_ = 0;
+public:
+    Dispatcher::Send send()
+    {
+        return
+            [this]()
+            {
+                std::unique_lock<std::mutex> lock{mutex_};
+
+                ++sent_;
+                maxRunning_ = std::max(maxRunning_, ++running_);
+                cond_.notify_all();
+                cond_.wait(lock, [this](){return open_;});
+                --running_;
+            };
+    }
+
+    void open()
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        open_ = true;
+        cond_.notify_all();
+    }
+
+    /* until n sends started */
+    void started(int n)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+
+        cond_.wait(lock, [this, n](){return n <= sent_;});
+    }
+
+    int sent()
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        return sent_;
+    }
+
+    int maxRunning()
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        return maxRunning_;
+    }
+};
+
+/* without pool, sent by the submitting thread before submit returns */
+void run()
+{
+    Dispatcher dispatcher{0, {}};
+
+    const auto caller = std::this_thread::get_id();
+    int sent = 0;
+
+    dispatcher.submit(
+        "s", "k", Overlap::SkipIfRunning,
+        [&]()
+        {
+            CHECK(caller == std::this_thread::get_id());
+            ++sent;
+        });
+
+    CHECK(1 == sent);
+
+    /* previous one completed, not skipped */
+    dispatcher.submit("s", "k", Overlap::SkipIfRunning, [&](){++sent;});
+
+    CHECK(2 == sent);
+    CHECK(0 == dispatcher.stats().skipped);
+}
+
+void allow()
+{
+    Gate gate;
+    Dispatcher dispatcher{THREADS, {}};
+
+    dispatcher.submit("s", "k", Overlap::Allow, gate.send());
+    dispatcher.submit("s", "k", Overlap::Allow, gate.send());
+    gate.started(2);
+    gate.open();
+    dispatcher.drain();
+
+    CHECK(2 == gate.maxRunning());
+}
+
+void skipIfRunning()
+{
+    Gate gate;
+    Dispatcher dispatcher{THREADS, {}};
+
+    dispatcher.submit("s", "k", Overlap::SkipIfRunning, gate.send());
+    gate.started(1);
+    dispatcher.submit("s", "k", Overlap::SkipIfRunning, gate.send());
+    /* other key is not affected */
+    dispatcher.submit("s", "other", Overlap::SkipIfRunning, gate.send());
+    gate.started(2);
+    gate.open();
+    dispatcher.drain();
+
+    CHECK(2 == gate.sent());
+    CHECK(1 == dispatcher.stats().skipped);
+
+    /* completed, runs again */
+    dispatcher.submit("s", "k", Overlap::SkipIfRunning, gate.send());
+    dispatcher.drain();
+
+    CHECK(3 == gate.sent());
+}
+
+void queueOne()
+{
+    Gate gate;
+    Dispatcher dispatcher{THREADS, {}};
+
+    dispatcher.submit("s", "k", Overlap::QueueOne, gate.send());
+    gate.started(1);
+    /* kept until the first completes, the one after is skipped */
+    dispatcher.submit("s", "k", Overlap::QueueOne, gate.send());
+    dispatcher.submit("s", "k", Overlap::QueueOne, gate.send());
+
+    CHECK(1 == gate.sent());
+
+    gate.open();
+    dispatcher.drain();
+
+    const auto stats = dispatcher.stats();
+
+    CHECK(2 == gate.sent());
+    CHECK(1 == gate.maxRunning());
+    CHECK(1 == stats.deferred);
+    CHECK(1 == stats.skipped);
+}
+
+void inFlight()
+{
+    constexpr int REQUESTS = 6;
+
+    Gate limited, other;
+    Dispatcher dispatcher{THREADS, {{"limited", 2}}};
+
+    for(int i = 0; i < REQUESTS; ++i)
+    {
+        dispatcher.submit("limited", "l" + std::to_string(i), Overlap::Allow, limited.send());
+    }
+
+    /* not held back by the limited service */
+    dispatcher.submit("other", "o", Overlap::Allow, other.send());
+    other.started(1);
+    limited.started(2);
+
+    auto stats = dispatcher.stats();
+
+    CHECK(2 == limited.sent());
+    CHECK(2 == stats.inFlight["limited"]);
+    CHECK(REQUESTS - 2 == int(stats.deferred));
+
+    other.open();
+    limited.open();
+    dispatcher.drain();
+
+    stats = dispatcher.stats();
+
+    CHECK(REQUESTS == limited.sent());
+    CHECK(2 == limited.maxRunning());
+    CHECK(stats.inFlight.empty());
+}
+
+/* batch keys are outstanding from reserve() until the request completes */
+void reserve()
+{
+    Gate gate;
+    Dispatcher dispatcher{THREADS, {}};
+
+    CHECK(dispatcher.reserve("a"));
+    CHECK(dispatcher.reserve("b"));
+    CHECK(!dispatcher.reserve("a"));
+
+    dispatcher.submit("s", {"a"}, gate.send());
+    /* not submitted */
+    dispatcher.cancel({"b"});
+
+    CHECK(dispatcher.reserve("b"));
+    dispatcher.cancel({"b"});
+
+    gate.started(1);
+    dispatcher.submit("s", "a", Overlap::SkipIfRunning, gate.send());
+
+    CHECK(1 == dispatcher.stats().skipped);
+
+    gate.open();
+    dispatcher.drain();
+
+    CHECK(dispatcher.reserve("a"));
+    dispatcher.cancel({"a"});
+}
+
+} /* namespace */
+
+int main()
+{
+    run();
+    allow();
+    skipIfRunning();
+    queueOne();
+    inFlight();
+    reserve();
+
+    return test::result();
+}
@@ -1,6 +1,9 @@
 #include <algorithm>
+#include <cerrno>
 #include <cstring>
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -42,7 +45,25 @@ bool isRegularFile(const std::string &path)
 
 bool isLink(const std::string &path)
 {
-    return S_ISLNK(statPath(path).st_mode);
+    ENSURE(!path.empty(), RuntimeError);
+
+    struct ::stat s;
+
+    ENSURE(0 == ::lstat(path.c_str(), &s), CRuntimeError);
+    return S_ISLNK(s.st_mode);
+}
+
+FileId fileId(const std::string &path)
+{
+    const auto s = statPath(path);
+
+    FileId id;
+
+    id.dev = s.st_dev;
+    id.ino = s.st_ino;
+    id.size = s.st_size;
+    id.mtimeNs = int64_t(s.st_mtim.tv_sec) * 1000000000 + s.st_mtim.tv_nsec;
+    return id;
 }
 
 PathSeq listDirectory(const std::string &path)
@@ -92,6 +113,43 @@ std::string resolvePath(const std::string &path)
     return rpath;
 }
 
+std::string resolveParent(const std::string &path)
+{
+    ENSURE(!path.empty(), RuntimeError);
+
+    auto trimmed = path;
+
+    while(1 < trimmed.size() && '/' == trimmed.back()) trimmed.pop_back();
+
+    const auto name = baseName(trimmed);
+
+    /* nothing to keep */
+    if(name.empty() || "." == name || ".." == name || "/" == trimmed) return resolvePath(path);
+
+    const auto separator = trimmed.rfind('/');
+    const auto parent = std::string::npos == separator ? std::string{"."} : parentPath(trimmed);
+    const auto rparent = resolvePath(parent);
+
+    return ("/" == rparent ? "" : rparent) + '/' + name;
+}
+
+std::string parentPath(const std::string &path)
+{
+    const auto separator = path.rfind('/');
+
+    if(std::string::npos == separator) return {};
+    if(0 == separator) return "/";
+    return path.substr(0, separator);
+}
+
+std::string baseName(const std::string &path)
+{
+    const auto separator = path.rfind('/');
+
+    if(std::string::npos == separator) return path;
+    return path.substr(separator + 1);
+}
+
 bool isExtention(const std::string &path, const std::string &ext)
 {
     const auto i =
@@ -103,3 +161,75 @@ bool isExtention(const std::string &path, const std::string &ext)
     if(std::distance(i, std::end(path)) != int(ext.size())) return false;
     return true;
 }
+
+void replaceFile(const std::string &path, const std::string &content)
+{
+    const auto tmpPath = path + ".tmp";
+    const auto fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    ENSURE(-1 != fd, CRuntimeError);
+
+    for(std::size_t offset = 0; content.size() > offset;)
+    {
+        const auto r = ::write(fd, content.data() + offset, content.size() - offset);
+
+        if(-1 == r && EINTR == errno) continue;
+        if(-1 == r) ::close(fd);
+        ENSURE(-1 != r, CRuntimeError);
+        offset += std::size_t(r);
+    }
+
+    const auto synced = 0 == ::fsync(fd);
+
+    ::close(fd);
+    ENSURE(synced, CRuntimeError);
+    ENSURE(0 == ::rename(tmpPath.c_str(), path.c_str()), CRuntimeError);
+
+    /* rename itself */
+    const auto parent = parentPath(path);
+    const auto dirFd =
+        ::open(parent.empty() ? "." : parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    ENSURE(-1 != dirFd, CRuntimeError);
+    ::fsync(dirFd);
+    ::close(dirFd);
+}
+
+MappedFile::MappedFile(const std::string &path)
+{
+    ENSURE(!path.empty(), RuntimeError);
+
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    ENSURE(-1 != fd_, CRuntimeError);
+
+    struct ::stat s;
+
+    if(0 != ::fstat(fd_, &s))
+    {
+        ::close(fd_);
+        ENSURE(false, CRuntimeError);
+    }
+
+    size_ = std::size_t(s.st_size);
+    /* empty file can't be mapped, begin() == end() */
+    if(0 == size_) return;
+
+    data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+
+    if(MAP_FAILED == data_)
+    {
+        data_ = nullptr;
+        ::close(fd_);
+        ENSURE(false, CRuntimeError);
+    }
+
+    /* file is parsed front to back once */
+    ::madvise(data_, size_, MADV_SEQUENTIAL);
+}
+
+MappedFile::~MappedFile()
+{
+    if(data_) ::munmap(data_, size_);
+    if(-1 != fd_) ::close(fd_);
+}
@@ -1,7 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include <dirent.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -21,10 +26,60 @@ AccessMode operator|(AccessMode x, AccessMode y)
     return AccessMode(int(x) | int(y));
 }
 
+/* identity of file content as of its last change,
+ * same id is taken for the same content */
+struct FileId
+{
+    dev_t dev = 0;
+    ino_t ino = 0;
+    off_t size = 0;
+    int64_t mtimeNs = 0;
+
+    bool operator==(const FileId &other) const
+    {
+        return
+            dev == other.dev
+            && ino == other.ino
+            && size == other.size
+            && mtimeNs == other.mtimeNs;
+    }
+
+    bool operator!=(const FileId &other) const {return !(*this == other);}
+};
+
 bool access(const std::string &path, AccessMode);
 bool isDirectory(const std::string &path);
 bool isRegularFile(const std::string &path);
+/* path itself (not its target) is a symbolic link */
 bool isLink(const std::string &path);
+/* of symbolic link target */
+FileId fileId(const std::string &path);
 PathSeq listDirectory(const std::string &path);
 std::string resolvePath(const std::string &path);
+/* parent resolved, last component kept as is (may be a symbolic link) */
+std::string resolveParent(const std::string &path);
+/* up to last component, "/" for top level */
+std::string parentPath(const std::string &path);
+std::string baseName(const std::string &path);
 bool isExtention(const std::string &path, const std::string &ext);
+/* written to a temporary file, synced and renamed over path,
+ * old or new content is found after a crash, never a partial one */
+void replaceFile(const std::string &path, const std::string &content);
+
+/* read only private mapping of the whole file */
+class MappedFile
+{
+    int fd_ = {-1};
+    void *data_ = nullptr;
+    std::size_t size_ = 0;
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *begin() const {return static_cast<const char *>(data_);}
+    const char *end() const {return begin() + size_;}
+    std::size_t size() const {return size_;}
+};
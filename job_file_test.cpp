@@ -0,0 +1,127 @@
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "Job.h"
+#include "fs.h"
+#include "testing.h"
+
+/* the same jobs loaded from json, cbor and msgpack files (JobSax)
+ * against parseJob() of the document */
+
+namespace {
+
+using namespace cron;
+
+/* nested payloads, every value type, optional fields */
+const auto JOBS = R"([
+    {
+        "at": {"second": [0, 30], "minute": [5]},
+        "service": "a",
+        "payload": ["${job_id}", {"n": -1, "f": 0.5, "t": true, "z": null, "s": "at ${scheduled_ts}"}]
+    },
+    {
+        "at": {"hour": [23], "week_day": [1, 7], "month_day": [31], "month": [12]},
+        "service": "b",
+        "payload": [[1, [2, [3]]], {"${seq}": "${seq}", "o": {"p": {}}, "a": []}, 18446744073709551615],
+        "priority": 3,
+        "deadline_ms": 250,
+        "overlap": "skip_if_running"
+    },
+    {
+        "at": {},
+        "service": "c",
+        "payload": [],
+        "overlap": "queue_one"
+    }
+])";
+
+std::string text(const Job &job)
+{
+    std::ostringstream os;
+
+    os
+        << job
+        << ' ' << job.priority()
+        << ' ' << job.deadline().count()
+        << ' ' << int(job.overlap());
+
+    return os.str();
+}
+
+void compare(const std::string &path, const json &document)
+{
+    const auto jobSeq = loadJobFile(path);
+
+    CHECK(document.size() == jobSeq.size());
+
+    for(std::size_t i = 0; i < jobSeq.size() && i < document.size(); ++i)
+    {
+        const auto id = path + '#' + std::to_string(i);
+        const auto expected = parseJob(path, id, document[i]);
+
+        CHECK(id == jobSeq[i].id());
+        CHECK(text(expected) == text(jobSeq[i]));
+        CHECK(expected.payload().source() == jobSeq[i].payload().source());
+    }
+}
+
+template <typename F>
+bool throws(F f)
+{
+    try
+    {
+        f();
+    }
+    catch(...)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+} /* namespace */
+
+int main()
+{
+    char dir[] = "/tmp/job_file_test.XXXXXX";
+
+    if(!::mkdtemp(dir)) return EXIT_FAILURE;
+
+    const std::string base = dir;
+    const auto document = json::parse(JOBS);
+    const auto cbor = json::to_cbor(document);
+    const auto msgpack = json::to_msgpack(document);
+
+    const std::vector<std::pair<std::string, std::string>> files =
+    {
+        {base + "/jobs.json", document.dump()},
+        {base + "/jobs.cbor", std::string(cbor.begin(), cbor.end())},
+        {base + "/jobs.msgpack", std::string(msgpack.begin(), msgpack.end())},
+        /* cut in the middle of a job */
+        {base + "/cut.cbor", std::string(cbor.begin(), cbor.begin() + cbor.size() / 2)},
+        /* not an array of jobs */
+        {base + "/object.msgpack", [](){const auto v = json::to_msgpack(json{{"a", 1}}); return std::string(v.begin(), v.end());}()}
+    };
+
+    for(const auto &i : files) replaceFile(i.first, i.second);
+
+    for(int i = 0; i < 3; ++i)
+    {
+        CHECK(isJobFile(files[i].first));
+        compare(files[i].first, document);
+    }
+
+    CHECK(throws([&](){loadJobFile(files[3].first);}));
+    CHECK(throws([&](){loadJobFile(files[4].first);}));
+    CHECK(!isJobFile(base + "/jobs.txt"));
+
+    for(const auto &i : files) ::unlink(i.first.c_str());
+    ::rmdir(dir);
+
+    return test::result();
+}
@@ -0,0 +1,108 @@
+#include <string>
+
+#include "PayloadTemplate.h"
+#include "testing.h"
+
+/* PayloadTemplate placeholder splicing, rendered frames are compared as json */
+
+namespace {
+
+using cron::json;
+using cron::PayloadTemplate;
+
+const PayloadTemplate::Fields FIELDS = {1700000000123, 42};
+
+json rendered(const PayloadTemplate &payload, const PayloadTemplate::Fields &fields = FIELDS)
+{
+    std::string frame;
+
+    payload.render(frame, fields);
+    return json::parse(frame);
+}
+
+json rendered(const char *input, const std::string &jobId = "job")
+{
+    return rendered(PayloadTemplate{json::parse(input), jobId});
+}
+
+/* number making up a whole string is spliced as number, inside a longer one as text */
+void wholeString()
+{
+    CHECK(json::parse(R"([42, 1700000000123, 1700000000])")
+        == rendered(R"(["${seq}", "${scheduled_ms}", "${scheduled_ts}"])"));
+
+    CHECK(json::parse(R"(["seq 42", "42 ", "1700000000-42"])")
+        == rendered(R"(["seq ${seq}", "${seq} ", "${scheduled_ts}-${seq}"])"));
+
+    CHECK(json::parse(R"({"a": {"b": [42]}})") == rendered(R"({"a": {"b": ["${seq}"]}})"));
+}
+
+/* object keys stay strings, whole or not */
+void keys()
+{
+    CHECK(json::parse(R"({"42": 42, "k42": "v42"})")
+        == rendered(R"({"${seq}": "${seq}", "k${seq}": "v${seq}"})"));
+
+    CHECK(json::parse(R"({"42": {"42": [42]}})") == rendered(R"({"${seq}": {"${seq}": ["${seq}"]}})"));
+}
+
+/* quotes escaped in the text are not string delimiters */
+void escaped()
+{
+    CHECK(json::parse(R"(["\"42\"", "a\\", 42, "\\42"])")
+        == rendered(R"(["\"${seq}\"", "a\\", "${seq}", "\\${seq}"])"));
+
+    /* unknown and unterminated placeholders are kept as they are */
+    CHECK(json::parse(R"(["${unknown}", "${seq"])") == rendered(R"(["${unknown}", "${seq"])"));
+}
+
+/* job id is resolved when compiled, escaped as json text */
+void jobId()
+{
+    const PayloadTemplate payload{json::parse(R"({"id": "${job_id}", "of": "job ${job_id}"})"), "a\"b"};
+
+    CHECK(payload.isStatic());
+    CHECK(json::parse(R"({"id": "a\"b", "of": "job a\"b"})") == json::parse(payload.text()));
+    CHECK(json::parse(payload.text()) == rendered(payload));
+}
+
+/* one-shot: compiled with the timer id, handed over as source() and
+ * compiled again by the successor to the same frames */
+void oneShot()
+{
+    const auto input =
+        json::parse(R"([{"timer": "${job_id}", "${seq}": "${scheduled_ms}", "at": "at ${scheduled_ts}"}, "\"${seq}\""])");
+
+    const PayloadTemplate payload{input, "timer:7"};
+    const PayloadTemplate successor{json::parse(payload.source()), "timer:other"};
+
+    const auto expected =
+        json::parse(R"([{"timer": "timer:7", "42": 1700000000123, "at": "at 1700000000"}, "\"42\""])");
+
+    CHECK(!payload.isStatic());
+    CHECK(expected == rendered(payload));
+    CHECK(expected == rendered(successor));
+    CHECK(payload.source() == successor.source());
+
+    /* unused timer slot */
+    const PayloadTemplate empty;
+    std::string frame = "stale";
+
+    empty.render(frame, FIELDS);
+
+    CHECK(empty.isStatic());
+    CHECK(frame.empty());
+}
+
+} /* namespace */
+
+int main()
+{
+    wholeString();
+    keys();
+    escaped();
+    jobId();
+    oneShot();
+
+    return test::result();
+}
@@ -0,0 +1,178 @@
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include <getopt.h>
+
+#include "FireRing.h"
+
+namespace {
+
+/* reader poll period when ring is drained */
+constexpr auto POLL = std::chrono::milliseconds{1};
+/* claimed record not complete this long, its writer is gone */
+constexpr auto ABANDONED = std::chrono::milliseconds{100};
+
+void help(const char *argv0, const char *message = nullptr)
+{
+    if(message) std::cout << "WARNING: " << message << '\n';
+
+    std::cout
+        << argv0
+        << " -r ring"
+        << " [-a]"
+        << " [-n]"
+        << '\n'
+        << "    -a: start with oldest record kept, latest otherwise"
+        << '\n'
+        << "    -n: print records available and exit, follow otherwise"
+        << '\n'
+        << "    columns: scheduled_ns lateness_us latency_us outcome service job"
+        << '\n'
+        << "    # lost N: records overwritten before read, # abandoned N: writer died in it"
+        << std::endl;
+}
+
+const char *outcome(uint32_t value)
+{
+    switch(value)
+    {
+        case FireRecord::Ok: return "ok";
+        case FireRecord::Failed: return "failed";
+        case FireRecord::Late: return "late";
+    }
+
+    return "unknown";
+}
+
+void print(const FireRecord &record)
+{
+    std::cout
+        << record.scheduledNs
+        << ' ' << (record.dispatchedNs - record.scheduledNs) / 1000
+        << ' ' << (record.completedNs - record.dispatchedNs) / 1000
+        << ' ' << outcome(record.outcome)
+        << ' ' << record.service
+        << ' ' << record.job
+        << '\n';
+}
+
+} /* namespace */
+
+int main(int argc, char *const argv[])
+{
+    std::string name;
+    bool all = false;
+    bool follow = true;
+
+    for(int c; -1 != (c = ::getopt(argc, argv, "hr:an"));)
+    {
+        switch(c)
+        {
+            case 'h':
+                help(argv[0]);
+                return EXIT_SUCCESS;
+                break;
+            case 'r':
+                name = optarg ? optarg : "";
+                break;
+            case 'a':
+                all = true;
+                break;
+            case 'n':
+                follow = false;
+                break;
+            case ':':
+            case '?':
+            default:
+                help(argv[0], "geopt() failure");
+                return EXIT_FAILURE;
+                break;
+        }
+    }
+
+    if(name.empty())
+    {
+        help(argv[0], "missing/invalid required arguments");
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        const FireRing ring{name};
+        const auto capacity = ring.capacity();
+
+        auto head = ring.head();
+        auto next = all && head > capacity ? head - capacity : (all ? 0 : head);
+
+        FireRecord record;
+        /* since when next has been claimed but not complete */
+        std::chrono::steady_clock::time_point claimed;
+
+        for(;;)
+        {
+            head = ring.head();
+
+            /* lapped by writers */
+            if(head > next + capacity)
+            {
+                std::cout << "# lost " << head - capacity - next << '\n';
+                next = head - capacity;
+                claimed = {};
+            }
+
+            if(next == head)
+            {
+                if(!follow) break;
+
+                std::cout.flush();
+                std::this_thread::sleep_for(POLL);
+                continue;
+            }
+
+            if(ring.read(next, record))
+            {
+                print(record);
+                ++next;
+                claimed = {};
+                continue;
+            }
+
+            /* overwritten while reading, skip it */
+            if(ring.head() > next + capacity)
+            {
+                continue;
+            }
+
+            /* claimed, not written yet */
+            const auto now = std::chrono::steady_clock::now();
+
+            if(std::chrono::steady_clock::time_point{} == claimed) claimed = now;
+
+            if(now - claimed > ABANDONED)
+            {
+                std::cout << "# abandoned " << next << '\n';
+                ++next;
+                claimed = {};
+                continue;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+    catch(const std::exception &except)
+    {
+        std::cerr << "std exception " << except.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch(...)
+    {
+        std::cerr << "unsupported exception" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout.flush();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Job.h"
+#include "Schedule.h"
+#include "testing.h"
+
+/* bit sliced schedule kernels against per job scan
+ *
+ * Every supported kernel must give the scalar kernel's bitmap, which
+ * must give the per job scan's (AtValue) one, for every sampled second.
+ * Match time of each is reported, exit status is the check result. */
+
+namespace {
+
+using namespace cron;
+using Kernel = Schedule::Kernel;
+
+constexpr std::size_t JOBS = 1000000;
+constexpr std::size_t SAMPLES = 200;
+/* sampled seconds spread over this many days */
+constexpr std::time_t DAYS = 4 * 366;
+constexpr std::time_t ORIGIN = 1704067200; /* 2024-01-01 */
+
+struct Named
+{
+    Kernel kernel;
+    const char *name;
+};
+
+const Named KERNELS[] =
+{
+    {Kernel::Scalar, "scalar"},
+    {Kernel::Sse2, "sse2"},
+    {Kernel::Avx2, "avx2"}
+};
+
+/* what dispatch did before the schedule was bit sliced */
+void scan(const JobSeq &jobSeq, const std::tm &tm, Schedule::Bitmap &due)
+{
+    due.assign((jobSeq.size() + Schedule::WORD_BITS - 1) / Schedule::WORD_BITS, 0);
+
+    for(std::size_t i = 0; i < jobSeq.size(); ++i)
+    {
+        if(jobSeq[i].expired(tm))
+        {
+            due[i / Schedule::WORD_BITS] |= Schedule::Word(1) << (i % Schedule::WORD_BITS);
+        }
+    }
+}
+
+struct Timing
+{
+    double min = 1e30;
+    double total = 0;
+
+    void add(std::chrono::steady_clock::duration elapsed)
+    {
+        const auto us = std::chrono::duration<double, std::micro>(elapsed).count();
+
+        min = std::min(min, us);
+        total += us;
+    }
+};
+
+template <typename F>
+void timed(Timing &timing, F f)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    f();
+    timing.add(std::chrono::steady_clock::now() - start);
+}
+
+} /* namespace */
+
+int main(int argc, char *argv[])
+{
+    const auto size = argc > 1 ? std::size_t(std::stoul(argv[1])) : JOBS;
+    const auto samples = argc > 2 ? std::size_t(std::stoul(argv[2])) : SAMPLES;
+
+    std::mt19937 rng{42};
+
+    const auto jobSeq = test::generate(size, rng);
+
+    std::vector<const Job *> jobs;
+
+    for(const auto &job : jobSeq) jobs.push_back(&job);
+
+    Timing build;
+    Schedule schedule;
+
+    timed(build, [&](){schedule = Schedule{jobs};});
+
+    Timing scanTiming;
+    std::vector<Timing> kernelTiming(sizeof(KERNELS) / sizeof(KERNELS[0]));
+    Schedule::Bitmap expected, scalar, due;
+    std::size_t mismatches = 0, dueCount = 0;
+
+    for(std::size_t s = 0; s < samples; ++s)
+    {
+        const std::time_t t = ORIGIN + std::time_t(rng() % uint32_t(DAYS * 86400));
+        std::tm tm;
+
+        ::localtime_r(&t, &tm);
+
+        timed(scanTiming, [&](){scan(jobSeq, tm, expected);});
+        schedule.match(tm, scalar, Kernel::Scalar);
+
+        if(expected != scalar) ++mismatches;
+
+        for(const auto word : expected) dueCount += std::size_t(__builtin_popcountll(word));
+
+        for(std::size_t k = 0; k < kernelTiming.size(); ++k)
+        {
+            if(!Schedule::supported(KERNELS[k].kernel)) continue;
+
+            timed(kernelTiming[k], [&](){schedule.match(tm, due, KERNELS[k].kernel);});
+
+            if(scalar != due)
+            {
+                std::cerr << KERNELS[k].name << " differs from scalar at " << t << '\n';
+                ++mismatches;
+            }
+        }
+    }
+
+    std::cout
+        << std::fixed << std::setprecision(1)
+        << size << " jobs, " << samples << " seconds, " << dueCount << " due"
+        << ", build " << build.total / 1000 << " ms\n"
+        << "per job scan: min " << scanTiming.min
+        << " us avg " << scanTiming.total / double(samples) << " us\n";
+
+    for(std::size_t k = 0; k < kernelTiming.size(); ++k)
+    {
+        if(!Schedule::supported(KERNELS[k].kernel)) continue;
+
+        std::cout
+            << KERNELS[k].name
+            << ": min " << kernelTiming[k].min
+            << " us avg " << kernelTiming[k].total / double(samples) << " us\n";
+    }
+
+    std::cout << (mismatches ? "FAILED " : "OK ") << mismatches << " mismatches" << std::endl;
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,113 @@
+#include <ctime>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Job.h"
+#include "Simulation.h"
+#include "testing.h"
+
+/* --simulate replay (Simulation) against firing every second by brute force */
+
+namespace {
+
+using namespace cron;
+using namespace std::chrono;
+
+/* firing time, index into jobs */
+using FireSeq = std::vector<std::pair<Clock::time_point, std::size_t>>;
+
+/* DST changes in March and October */
+constexpr auto TIME_ZONE = "Europe/Berlin";
+constexpr std::size_t JOBS = 100;
+
+FireSeq simulated(const Simulation::JobPtrSeq &jobs, Clock::time_point from, Clock::time_point to)
+{
+    Simulation simulation{jobs};
+    VirtualTime time{from};
+    FireSeq fireSeq;
+
+    simulation.run(
+        time,
+        to,
+        [&fireSeq](Clock::time_point at, std::size_t index)
+        {
+            fireSeq.emplace_back(at, index);
+        });
+
+    return fireSeq;
+}
+
+/* what the tick loop fires, every whole second in [from, to) */
+FireSeq bruteForce(const Simulation::JobPtrSeq &jobs, Clock::time_point from, Clock::time_point to)
+{
+    FireSeq fireSeq;
+
+    auto tick = time_point_cast<seconds>(from);
+
+    if(tick < from) tick += seconds{1};
+
+    for(; tick < to; tick += seconds{1})
+    {
+        const auto tm = TimeSource::localtime(tick);
+
+        for(std::size_t i = 0; i < jobs.size(); ++i)
+        {
+            if(jobs[i]->expired(tm)) fireSeq.emplace_back(tick, i);
+        }
+    }
+
+    return fireSeq;
+}
+
+Clock::time_point civil(int year, int month, int day, int hour = 0)
+{
+    std::tm tm{};
+
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    tm.tm_isdst = -1;
+
+    return Clock::from_time_t(std::mktime(&tm));
+}
+
+void compare(const Simulation::JobPtrSeq &jobs, Clock::time_point from, Clock::time_point to)
+{
+    const auto expected = bruteForce(jobs, from, to);
+    const auto actual = simulated(jobs, from, to);
+
+    CHECK(!expected.empty());
+    CHECK(expected.size() == actual.size());
+    CHECK(expected == actual);
+}
+
+} /* namespace */
+
+int main()
+{
+    ::setenv("TZ", TIME_ZONE, 1);
+    ::tzset();
+
+    std::mt19937 rng{29};
+
+    const auto jobSeq = test::generate(JOBS, rng);
+
+    Simulation::JobPtrSeq jobs;
+
+    for(const auto &job : jobSeq) jobs.push_back(&job);
+
+    /* leap day and month end */
+    compare(jobs, civil(2024, 2, 29, 22), civil(2024, 3, 1, 2));
+    /* DST starts, 02:00 to 02:59 do not exist */
+    compare(jobs, civil(2024, 3, 31, 0), civil(2024, 3, 31, 4));
+    /* DST ends, 02:00 to 02:59 come twice */
+    compare(jobs, civil(2024, 10, 27, 0), civil(2024, 10, 27, 4));
+    /* year end */
+    compare(jobs, civil(2024, 12, 31, 22), civil(2025, 1, 1, 2));
+    /* range not on whole seconds */
+    compare(jobs, civil(2025, 6, 1, 12) + milliseconds{300}, civil(2025, 6, 1, 14) + milliseconds{700});
+
+    return test::result();
+}
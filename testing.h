@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "Job.h"
+
+/* shared by tests and benchmarks, header only */
+
+namespace test {
+
+inline int &failures()
+{
+    static int failures = 0;
+
+    return failures;
+}
+
+inline void check(bool condition, const char *text, int line)
+{
+    if(condition) return;
+
+    std::cerr << "FAILED line " << line << ": " << text << std::endl;
+    ++failures();
+}
+
+#define CHECK(condition) test::check((condition), #condition, __LINE__)
+
+/* prints the outcome, exit status of the test */
+inline int result()
+{
+    std::cout << (failures() ? "FAILED" : "OK") << std::endl;
+    return failures() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* random jobs, a mix of wildcard and listed fields as job files have */
+inline cron::JobSeq generate(std::size_t size, std::mt19937 &rng)
+{
+    using cron::json;
+
+    const auto values =
+        [&rng](int min, int max, int count)
+        {
+            json seq = json::array();
+
+            for(auto n = 1 + int(rng() % unsigned(count)); n; --n)
+            {
+                seq.push_back(min + int(rng() % unsigned(max - min + 1)));
+            }
+
+            return seq;
+        };
+
+    cron::JobSeq jobSeq;
+
+    jobSeq.reserve(size);
+
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        json at = json::object();
+
+        if(rng() % 4) at["second"] = values(0, 59, 3);
+        if(rng() % 2) at["minute"] = values(0, 59, 3);
+        if(rng() % 2) at["hour"] = values(0, 23, 3);
+        if(0 == rng() % 5) at["week_day"] = values(1, 7, 3);
+        if(0 == rng() % 5) at["month_day"] = values(1, 31, 3);
+        if(0 == rng() % 5) at["month"] = values(1, 12, 3);
+
+        const json input = {{"at", at}, {"service", "s"}, {"payload", json::array()}};
+
+        jobSeq.push_back(cron::parseJob("test", std::to_string(i), input));
+    }
+
+    return jobSeq;
+}
+
+} /* test */
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "TimingWheel.h"
+#include "testing.h"
+
+/* TimingWheel against the expiries it was given */
+
+namespace {
+
+using Wheel = TimingWheel<uint64_t>;
+
+/* every level, fired exactly at expiry however time is advanced,
+ * expiry() is never past the earliest pending timer */
+void cascade()
+{
+    const uint64_t NOW = 1000;
+    /* timer value is its expiry */
+    const std::vector<uint64_t> expiries =
+    {
+        NOW + 1,
+        NOW + 63,
+        NOW + 64,
+        NOW + 4095,
+        NOW + 4096,
+        NOW + (uint64_t(1) << 18) + 5,
+        NOW + (uint64_t(1) << 30) + 7,
+        NOW + (uint64_t(1) << 40) + 3
+    };
+
+    std::mt19937 rng{28};
+
+    for(int pass = 0; pass < 2; ++pass)
+    {
+        Wheel wheel{NOW};
+        std::vector<uint64_t> fired;
+
+        const auto f =
+            [&wheel, &fired](Wheel::Handle, uint64_t &&expiry)
+            {
+                CHECK(expiry == wheel.now());
+                fired.push_back(expiry);
+            };
+
+        for(const auto expiry : expiries) wheel.insert(expiry, uint64_t(expiry));
+
+        CHECK(expiries.size() == wheel.size());
+
+        const auto end = expiries.back() + 1;
+
+        /* in one go, then in random steps of up to 2^31 ticks */
+        while(wheel.now() < end)
+        {
+            const auto step = pass ? 1 + rng() % (uint64_t(1) << (rng() % 32)) : end;
+
+            if(!wheel.empty()) CHECK(wheel.expiry() <= expiries[fired.size()]);
+
+            wheel.advance(std::min(wheel.now() + step, end), f);
+        }
+
+        CHECK(expiries == fired);
+        CHECK(wheel.empty());
+    }
+}
+
+/* handles of cancelled or fired timers (and reused nodes) are rejected */
+void staleCancel()
+{
+    Wheel wheel;
+
+    const auto first = wheel.insert(10, 10);
+
+    CHECK(wheel.cancel(first));
+    CHECK(!wheel.cancel(first));
+
+    /* same node, next generation */
+    const auto second = wheel.insert(20, 20);
+
+    CHECK(uint32_t(first) == uint32_t(second));
+    CHECK(!wheel.cancel(first));
+    CHECK(1 == wheel.size());
+
+    std::vector<uint64_t> fired;
+
+    wheel.advance(20, [&fired](Wheel::Handle, uint64_t &&expiry) {fired.push_back(expiry);});
+
+    CHECK(std::vector<uint64_t>{20} == fired);
+    CHECK(!wheel.cancel(second));
+    CHECK(!wheel.cancel(Wheel::Handle(12345)));
+}
+
+/* expiry at or before now fires on next advance, time does not move */
+void dueOnInsert()
+{
+    Wheel wheel{100};
+
+    wheel.insert(50, 50);
+    wheel.insert(100, 100);
+
+    CHECK(100 == wheel.expiry());
+
+    std::vector<uint64_t> fired;
+
+    wheel.advance(100, [&fired](Wheel::Handle, uint64_t &&expiry) {fired.push_back(expiry);});
+
+    std::sort(fired.begin(), fired.end());
+
+    CHECK((std::vector<uint64_t>{50, 100} == fired));
+    CHECK(100 == wheel.now());
+    CHECK(wheel.empty());
+}
+
+/* timers of one wheel restored in another under the same handles */
+void restore()
+{
+    Wheel from{1000};
+    std::vector<Wheel::Handle> handles;
+
+    for(uint64_t i = 0; i < 8; ++i) handles.push_back(from.insert(2000 + i, 2000 + i));
+
+    /* holes in the pool, bumped generations */
+    from.cancel(handles[1]);
+    from.cancel(handles[5]);
+    handles[1] = from.insert(3001, 3001);
+
+    Wheel to{1500};
+
+    from.forEach(
+        [&to](Wheel::Handle handle, const uint64_t &expiry)
+        {
+            CHECK(to.insert(handle, expiry, uint64_t(expiry)));
+        });
+
+    CHECK(from.size() == to.size());
+
+    /* node in use */
+    CHECK(!to.insert(handles[0], 4000, 4000));
+
+    /* fresh timer does not take a restored node */
+    const auto fresh = to.insert(4000, 4000);
+
+    CHECK(handles.end() == std::find(handles.begin(), handles.end(), fresh));
+    CHECK(to.cancel(handles[1]));
+    CHECK(!to.cancel(handles[5]));
+    CHECK(to.cancel(fresh));
+
+    std::vector<uint64_t> fired;
+
+    to.advance(5000, [&fired](Wheel::Handle, uint64_t &&expiry) {fired.push_back(expiry);});
+
+    CHECK((std::vector<uint64_t>{2000, 2002, 2003, 2004, 2006, 2007} == fired));
+}
+
+/* past the horizon is rejected before a node is taken */
+void outOfRange()
+{
+    Wheel wheel{1000};
+
+    const auto far = 1000 + (uint64_t(1) << 42);
+
+    CHECK(!wheel.fits(far));
+    CHECK(wheel.fits(1000 + (uint64_t(1) << 41)));
+    CHECK(wheel.fits(0));
+
+    const auto vacant = wheel.vacant();
+    bool thrown = false;
+
+    try
+    {
+        wheel.insert(far, uint64_t(far));
+    }
+    catch(...)
+    {
+        thrown = true;
+    }
+
+    CHECK(thrown);
+    thrown = false;
+
+    try
+    {
+        wheel.insert(Wheel::Handle(3), far, uint64_t(far));
+    }
+    catch(...)
+    {
+        thrown = true;
+    }
+
+    CHECK(thrown);
+    CHECK(wheel.empty());
+    CHECK(vacant == wheel.vacant());
+    CHECK(vacant == wheel.insert(2000, 2000));
+}
+
+} /* namespace */
+
+int main()
+{
+    cascade();
+    staleCancel();
+    dueOnInsert();
+    restore();
+    outOfRange();
+
+    return test::result();
+}